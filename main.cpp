@@ -3,17 +3,48 @@
 #include <vector>
 #include <thread>
 #include <iomanip>
+#include <sstream>
 #include "src/config.h"
 #include "src/utils.h"
 #include "src/globals.h"
 #include "src/memory_manager.h"
 #include "src/instruction.h"
+#include "src/bytecode.h"
 #include "src/process.h"
 #include "src/scheduler.h"
 #include "src/reports.h"
+#include "src/run_queue.h"
+#include "src/sim_clock.h"
+#include "src/scheduling_policy.h"
+#include "src/process_generator.h"
+#include "src/page_trace.h"
+#include "src/contiguous_allocator.h"
 #include <fstream>
 
+// processNames is shared with the generator thread, which adds to it under
+// sessionMutex, so main only touches it through these.
+static void nameProcess(int pid, const std::string& name) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    processNames[pid] = name;
+}
+
+static std::string processName(int pid) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    auto it = processNames.find(pid);
+    return it != processNames.end() ? it->second : "";
+}
+
+// -1 if no process has that name.
+static int findProcessByName(const std::string& name) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    for (const auto& pair : processNames) {
+        if (pair.second == name) return pair.first;
+    }
+    return -1;
+}
+
 void displayProcessSmi() {
+    std::lock_guard<std::mutex> lock(sessionMutex);
 
     auto now = Clock::now();
     std::time_t t = Clock::to_time_t(now);
@@ -57,8 +88,7 @@ void displayProcessSmi() {
     std::cout << "|                                         |                        |                  N/A |\n";
     std::cout << "+-----------------------------------------+------------------------+----------------------+\n";
     
-    int pageFaults, pageReplacements, framesUsed;
-    demandPagingAllocator.getStatistics(pageFaults, pageReplacements, framesUsed);
+    PagingStatistics paging = demandPagingAllocator.getStatistics();
     
     std::cout << "\n";
     std::cout << "+-----------------------------------------------------------------------------------------+\n";
@@ -72,7 +102,7 @@ void displayProcessSmi() {
         const auto& session = entry.second;
         std::string processName = processNames[pid];
         std::string status = session.finished ? "Done" : "Run ";
-        int assignedCore = (pid - 1) % config.num_cpu;
+        std::string assignedCore = session.lastCore >= 0 ? std::to_string(session.lastCore) : "-";
         int memoryKB = session.memorySize / 1024;
         
         if (processName.length() > 30) {
@@ -97,20 +127,51 @@ void displayProcessSmi() {
     std::cout << "  Used Memory: " << totalMemoryUsed << " bytes (" << totalMemoryUsed/1024 << " KB)\n";
     std::cout << "  Free Memory: " << (config.max_memory_size - totalMemoryUsed) << " bytes (" 
               << (config.max_memory_size - totalMemoryUsed)/1024 << " KB)\n";
-    std::cout << "  Page Faults: " << pageFaults << "\n";
-    std::cout << "  Page Replacements: " << pageReplacements << "\n";
-    std::cout << "  Frames Used: " << framesUsed << "/" << config.num_frames << "\n";
+    std::cout << "  Page Faults: " << paging.pageFaults << "\n";
+    std::cout << "  Page Replacements: " << paging.pageReplacements << "\n";
+    std::cout << "  Dirty Write-backs: " << paging.dirtyWritebacks << "\n";
+    std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2) << paging.hitRatio() * 100 << "%\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << "  Frames Used: " << paging.framesUsed << "/" << config.num_frames << "\n";
+}
+
+// Fault-path latency histograms in microseconds, merged over the cores and
+// then the whole-fault time of each core.
+void displayFaultLatency() {
+    static const char* stageNames[FAULT_STAGES] = {"Victim Selection", "Write-back", "Swap-in", "Fault Service"};
+    auto printRow = [](const std::string& label, const LatencySnapshot& latency) {
+        std::cout << std::left << std::setw(16) << label << std::right << " | "
+                  << std::setw(9) << latency.samples << " | " << std::fixed << std::setprecision(2);
+        for (double q : {0.50, 0.90, 0.99}) std::cout << std::setw(9) << latency.percentile(q) / 1000.0 << " | ";
+        std::cout << std::setw(9) << latency.maxNanos / 1000.0 << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    };
+    
+    std::cout << "\n===== FAULT LATENCY (us) =====\n";
+    std::cout << "Stage            |   Samples |       p50 |       p90 |       p99 |       Max\n";
+    std::cout << "-----------------|-----------|-----------|-----------|-----------|----------\n";
+    for (int stage = 0; stage < FAULT_STAGES; ++stage) {
+        printRow(stageNames[stage], demandPagingAllocator.getFaultLatency(static_cast<FaultStage>(stage)));
+    }
+    
+    std::cout << "\nFault Service per Core:\n";
+    std::cout << "Core             |    Faults |       p50 |       p90 |       p99 |       Max\n";
+    std::cout << "-----------------|-----------|-----------|-----------|-----------|----------\n";
+    for (int i = 0; i <= config.num_cpu; ++i) {
+        LatencySnapshot latency = demandPagingAllocator.getFaultLatency(FaultStage::SERVICE, i);
+        if (i == config.num_cpu && latency.samples == 0) continue;
+        printRow(i < config.num_cpu ? std::to_string(i) : "other", latency);
+    }
+    std::cout << "==============================\n\n";
 }
 
 int main() {
     bool initialized = false;
     std::string line;
     std::thread scheduler;
+    std::thread generator;
     std::vector<std::thread> workers;
 
-    int next_pid = 1;
-    int round_robin_core = 0;
-
     clearScreen(); printHeader();
 
     while (true) {
@@ -128,9 +189,18 @@ int main() {
                     continue;
                 }
 
-                coreQueues = std::vector<std::queue<int>>(config.num_cpu);
-                coreMutexes = std::vector<std::mutex>(config.num_cpu);
-                coreCVs = std::vector<std::condition_variable>(config.num_cpu);
+                runQueues.init(config.num_cpu);
+                schedulingPolicy = createSchedulingPolicy(config.scheduler);
+                config.scheduler = schedulingPolicy->name();
+                simClock.configure(config.clock_mode == "virtual", config.tick_ms);
+                demandPagingAllocator.initialize();
+                contiguousAllocator.reset();
+                if (config.memory_allocator != "none") {
+                    contiguousAllocator = createContiguousAllocator(config.memory_allocator);
+                    config.memory_allocator = contiguousAllocator->name();
+                    contiguousAllocator->reset(config.max_memory_size);
+                }
+                enableSnapshots = contiguousAllocator != nullptr;
 
                 initialized = true;
                 clearScreen(); printHeader();
@@ -140,22 +210,36 @@ int main() {
             continue;
         }
 
-        memoryBlocks.clear();
-        memoryBlocks.push_back({0, config.max_memory_size - 1, -1}); 
-
         if (cmd == "scheduler-test") {
+            if (!workers.empty()) {
+                std::cout << "Scheduler is already running. Use 'scheduler-stop' first.\n";
+                continue;
+            }
             stopScheduler = false;
-            sessions.clear();
-            processNames.clear();
-            for (int i = 0; i < config.num_cpu; ++i) {
-                std::queue<int> empty;
-                std::swap(coreQueues[i], empty);
+            // The pager forgets the old layouts before the sessions owning them go
+            demandPagingAllocator.initialize();
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                sessions.clear();
+                processNames.clear();
+            }
+            if (contiguousAllocator) {
+                std::lock_guard<std::mutex> lock(memoryMutex);
+                contiguousAllocator->reset(config.max_memory_size);
             }
+            resetScheduler();
+            nextPid = 1;
+            generatorRunning = true;
+            admissionOpen = true;
 
+            // Workers, the scheduler and the generator share the clock; each detaches on exit
+            simClock.attach(config.num_cpu + 2);
             for (int i = 0; i < config.num_cpu; ++i)
                 workers.emplace_back(cpuWorkerWithInstructions, i);
             scheduler = std::thread(schedulerThread);
-            std::cout << "Started scheduling. Run 'screen -ls' every 1-2s.\n";
+            generator = std::thread(processGeneratorThread);
+            std::cout << "Started scheduling. A new process arrives every " << config.batch_process_freq
+                      << " ticks until 'scheduler-stop'. Run 'screen -ls' every 1-2s.\n";
         }
         else if (cmd.rfind("pagetable ", 0) == 0) {
             try {
@@ -209,31 +293,134 @@ int main() {
                 continue;
             }
             
-            int pid = next_pid++;
-            processNames[pid] = pname;
-            int assignedCore = round_robin_core++ % config.num_cpu;
+            std::shared_ptr<Program> program = std::make_shared<Program>();
+            if (!compileProgram(instructions, memorySize, *program)) {
+                std::cout << "Error: Failed to compile instructions.\n";
+                continue;
+            }
+            
+            int pid = nextPid++;
+            nameProcess(pid, pname);
             
             {
-                std::lock_guard<std::mutex> lock(coreMutexes[assignedCore]);
-                coreQueues[assignedCore].push(pid);
+                std::lock_guard<std::mutex> lock(sessionMutex);
                 Session s;
                 s.start = Clock::now();
                 s.finished = false;
                 s.memorySize = memorySize;
                 s.instructions = instructions;
+                s.program = program;
                 sessions[pid] = std::move(s);
                 
                 createProcessMemoryLayout(pid, memorySize);
             }
-            coreCVs[assignedCore].notify_one();
+            submitProcess(pid);
 
             std::cout << "Process '" << pname << "' created successfully!\n";
             std::cout << "  Memory size: " << memorySize << " bytes\n";
             std::cout << "  Instructions: " << instructions.size() << " parsed successfully\n";
-            std::cout << "  Assigned to core: " << assignedCore << "\n\n";
+            std::cout << "  Submitted to scheduler (PID " << pid << ")\n\n";
             
             printInstructions(instructions);
         }
+        else if (cmd.rfind("clone ", 0) == 0) {
+            std::stringstream args(cmd.substr(6));
+            std::string parentStr, cname, countStr;
+            int count = 1;
+            args >> parentStr >> cname >> countStr;
+            try {
+                if (!countStr.empty()) count = std::stoi(countStr);
+            } catch (const std::exception&) {
+                count = 0;
+            }
+            if (cname.empty() || count < 1) {
+                std::cout << "Error: Invalid command format.\n";
+                std::cout << "Usage: clone <pid|name> <new_name> [count]\n";
+                continue;
+            }
+            
+            int parentPid = -1;
+            try {
+                parentPid = std::stoi(parentStr);
+            } catch (const std::exception&) {
+                parentPid = findProcessByName(parentStr);
+            }
+            bool found = false, finished = false;
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                auto it = sessions.find(parentPid);
+                found = it != sessions.end();
+                finished = found && it->second.finished;
+            }
+            if (!found) {
+                std::cout << "Error: No such process found.\n";
+                continue;
+            }
+            if (finished) {
+                std::cout << "Error: Process " << parentPid << " has finished; only live processes can be cloned.\n";
+                continue;
+            }
+            
+            // Children share the parent's compiled program and, copy-on-write,
+            // its memory; each starts at the first instruction with nothing
+            // declared, as the parent's declarations belong to its own run.
+            // The parent may finish at any point, so it is checked again for
+            // every child.
+            std::vector<int> children;
+            for (int i = 1; i <= count; ++i) {
+                int pid;
+                {
+                    std::lock_guard<std::mutex> lock(sessionMutex);
+                    const Session& parent = sessions[parentPid];
+                    if (parent.finished) break;
+                    pid = nextPid++;
+                    Session s;
+                    s.start = Clock::now();
+                    s.finished = false;
+                    s.memorySize = parent.memorySize;
+                    s.instructions = parent.instructions;
+                    s.program = parent.program;
+                    s.priority = parent.priority;
+                    sessions[pid] = std::move(s);
+                    processNames[pid] = count == 1 ? cname : cname + "_" + std::to_string(i);
+                    
+                    createProcessMemoryLayout(pid, sessions[pid].memorySize, false);
+                }
+                if (!demandPagingAllocator.cloneProcess(parentPid, pid)) {
+                    // Never submitted, so nothing else will finish it
+                    demandPagingAllocator.freeProcessPages(pid);
+                    std::lock_guard<std::mutex> lock(sessionMutex);
+                    sessions.erase(pid);
+                    processNames.erase(pid);
+                    break;
+                }
+                submitProcess(pid);
+                children.push_back(pid);
+            }
+            
+            if (children.empty()) {
+                std::cout << "Error: Process " << parentPid << " finished before it could be cloned.\n";
+                continue;
+            }
+            // The generator may take PIDs between clones, so they are listed as runs
+            std::string pids;
+            for (size_t first = 0; first < children.size();) {
+                size_t last = first;
+                while (last + 1 < children.size() && children[last + 1] == children[last] + 1) ++last;
+                pids += (first > 0 ? ", " : "") + std::to_string(children[first]);
+                if (last > first) pids += "-" + std::to_string(children[last]);
+                first = last + 1;
+            }
+            int cloned = static_cast<int>(children.size());
+            CopyOnWriteStatistics cow = demandPagingAllocator.getCopyOnWriteStatistics();
+            std::cout << "Cloned '" << processName(parentPid) << "' into " << cloned << " process"
+                      << (cloned == 1 ? "" : "es") << " (PID " << pids << ").\n";
+            if (cloned < count) {
+                std::cout << "  Stopped after " << cloned << " of " << count << ": process " << parentPid << " finished.\n";
+            }
+            std::cout << "  Frames shared copy-on-write: " << cow.sharedFrames
+                      << " (" << cow.mappingsSaved << " page copies avoided)\n";
+        }
         else if (cmd.rfind("screen -s ", 0) == 0) {
             std::string pname;
             int memorySize;
@@ -259,12 +446,10 @@ int main() {
                 continue;
             }
             
-            int pid = next_pid++;
-            processNames[pid] = pname; 
-            int assignedCore = round_robin_core++ % config.num_cpu;
+            int pid = nextPid++;
+            nameProcess(pid, pname);
             {
-                std::lock_guard<std::mutex> lock(coreMutexes[assignedCore]);
-                coreQueues[assignedCore].push(pid);
+                std::lock_guard<std::mutex> lock(sessionMutex);
                 Session s;
                 s.start = Clock::now();
                 s.finished = false;
@@ -273,18 +458,25 @@ int main() {
                 
                 createProcessMemoryLayout(pid, memorySize);
             }
-            coreCVs[assignedCore].notify_one();
+            submitProcess(pid);
 
             std::cout << "Process '" << pname << "' created with " << memorySize << " bytes of memory.\n";
 
             while (true) {
                 clearScreen();
-                std::cout << "Process name: " << processNames[pid] << "\n";
+                std::cout << "Process name: " << processName(pid) << "\n";
+                int memorySize, numPages;
+                {
+                    std::lock_guard<std::mutex> lock(sessionMutex);
+                    const Session& session = sessions.at(pid);
+                    memorySize = session.memorySize;
+                    numPages = session.memoryLayout ? session.memoryLayout->pageTable.numPages : 0;
+                }
                 std::cout << "ID: " << pid << "\n";
-                std::cout << "Memory size: " << sessions[pid].memorySize << " bytes\n";
+                std::cout << "Memory size: " << memorySize << " bytes\n";
                 
-                if (sessions[pid].memoryLayout) {
-                    std::cout << "Pages needed: " << sessions[pid].memoryLayout->pageTable.numPages << "\n";
+                if (numPages > 0) {
+                    std::cout << "Pages needed: " << numPages << "\n";
                 }
                 
                 std::cout << "Logs:\n";
@@ -292,19 +484,25 @@ int main() {
                 std::string fname = std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid) + ".txt";
                 std::ifstream ifs(fname);
                 std::string logline;
-                int log_count = 0;
                 while (std::getline(ifs, logline)) {
                     std::cout << logline << "\n";
-                    log_count++;
                 }
                 ifs.close();
 
-                int current_line = log_count;
-                int total_lines = config.prints_per_process;
+                int current_line, total_lines;
+                bool finished;
+                {
+                    // The core running this process publishes its context under sessionMutex
+                    std::lock_guard<std::mutex> lock(sessionMutex);
+                    const Session& session = sessions.at(pid);
+                    current_line = session.context.programCounter;
+                    total_lines = programLength(session);
+                    finished = session.finished;
+                }
                 std::cout << "\nCurrent instruction line: " << current_line << "\n";
                 std::cout << "Lines of code: " << total_lines << "\n";
 
-                if (sessions[pid].finished) {
+                if (finished) {
                     std::cout << "\nFinished!\n";
                 }
 
@@ -337,6 +535,7 @@ int main() {
             continue;
         }
         else if (cmd == "screen -ls") {
+            std::lock_guard<std::mutex> lock(sessionMutex);
             std::cout << "Finished:\n";
             for (const auto& entry : sessions) {
                 if (entry.second.finished) {
@@ -360,9 +559,8 @@ int main() {
         }
         else if (cmd == "scheduler-stop") {
             stopScheduler = true;
-            for (int i = 0; i < config.num_cpu; ++i)
-                coreCVs[i].notify_all();
 
+            if (generator.joinable()) generator.join();
             if (scheduler.joinable()) scheduler.join();
             for (auto &t : workers)
                 if (t.joinable()) t.join();
@@ -374,44 +572,270 @@ int main() {
             generateMemoryReport();
         } else if (cmd == "vmstat") {
             std::cout << "\n===== VMSTAT =====\n";
+            std::cout << "Clock: tick " << simClock.now() << " (" << config.clock_mode << ")\n";
             std::cout << "Total CPU Active Ticks: " << total_cpu_active_ticks << "\n";
             std::cout << "Total CPU Idle Ticks: " << total_cpu_idle_ticks << "\n";
             std::cout << "\nPer-process CPU Ticks:\n";
-            for (const auto& entry : sessions) {
-                int pid = entry.first;
-                const Session& s = entry.second;
-                std::cout << "PID " << pid << " (" << processNames[pid] << ")"
-                          << ": Active Ticks = " << s.cpu_active_ticks
-                          << ", Idle Ticks = " << s.cpu_idle_ticks
-                          << (s.finished ? " [Finished]" : " [Running]")
-                          << "\n";
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                for (const auto& entry : sessions) {
+                    int pid = entry.first;
+                    const Session& s = entry.second;
+                    std::cout << "PID " << pid << " (" << processNames[pid] << ")"
+                              << ": Active Ticks = " << s.cpu_active_ticks
+                              << ", Idle Ticks = " << s.cpu_idle_ticks
+                              << (s.finished ? " [Finished]"
+                                  : s.context.state == ProcessState::SUSPENDED ? " [Suspended]" : " [Running]")
+                              << "\n";
+                }
+                std::cout << "\n";
+                writeSchedulingSummary(std::cout);
+            }
+            std::cout << "\nPer-core Run Queues (work stealing):\n";
+            std::cout << "Core | Queued | Dispatched | Steals | Stolen From | Failed Steals | Idle Ticks\n";
+            std::cout << "-----|--------|------------|--------|-------------|---------------|-----------\n";
+            long long totalSteals = 0;
+            for (int i = 0; i < runQueues.numCores(); ++i) {
+                const CoreQueueStats& qs = runQueues.coreStats(i);
+                totalSteals += qs.steals;
+                std::cout << std::setw(4) << i << " | "
+                          << std::setw(6) << runQueues.queueDepth(i) << " | "
+                          << std::setw(10) << qs.dispatched << " | "
+                          << std::setw(6) << qs.steals << " | "
+                          << std::setw(11) << qs.stolenFrom << " | "
+                          << std::setw(13) << qs.failedSteals << " | "
+                          << std::setw(10) << qs.idleTicks << "\n";
+            }
+            std::cout << "Total Steals: " << totalSteals << "\n";
+            if (config.pressure_high_faults > 0) {
+                PressureStatistics pressure = getPressureStatistics();
+                std::cout << "\nMemory Pressure (suspend above " << config.pressure_high_faults
+                          << " faults per " << config.pressure_window << " ticks, resume at "
+                          << config.pressure_low_faults << "):\n";
+                std::cout << "  Last Window: " << pressure.windowFaults << " faults, "
+                          << pressure.freeFrames << " free frames\n";
+                std::cout << "  Admission: " << (pressure.admissionHeld ? "held" : "open")
+                          << " (" << pressure.heldTicks << " ticks held)\n";
+                std::cout << "  Suspended: " << pressure.suspended << " now (" << pressure.suspensions
+                          << " suspensions, " << pressure.resumes << " resumes)\n";
+                std::cout << "  Frames Freed by Suspension: " << pressure.pagesSwappedOut << "\n";
+            }
+            if (config.writeback_watermark > 0 && !config.page_replacement_compare) {
+                WritebackStatistics wb = demandPagingAllocator.getWritebackStatistics();
+                PagingStatistics paging = demandPagingAllocator.getStatistics();
+                std::cout << "\nWrite-back Daemon (watermark " << config.writeback_watermark
+                          << " clean frames, batches of up to " << config.writeback_batch << "):\n";
+                std::cout << std::fixed << std::setprecision(2);
+                std::cout << "  Batches: " << wb.batches << " (avg " << wb.averageBatch()
+                          << " pages, largest " << wb.largestBatch << ")\n";
+                std::cout << "  Pages Cleaned: " << wb.pagesCleaned << " in " << wb.writes
+                          << " writes (" << wb.pagesPerWrite() << " pages/write)\n";
+                std::cout.unsetf(std::ios::fixed);
+                std::cout << "  Eviction Stalls (dirty victim written during fault): " << paging.dirtyWritebacks << "\n";
+                std::cout << "  In-flight Waits (fault waited on a batch): " << wb.inFlightWaits << "\n";
+            }
+            if (config.readahead_max > 0 && !config.page_replacement_compare) {
+                ReadaheadStatistics ra = demandPagingAllocator.getReadaheadStatistics();
+                std::cout << "\nReadahead (up to " << config.readahead_max << " pages):\n";
+                std::cout << "  Batched Reads: " << ra.reads << "\n";
+                std::cout << "  Pages Prefetched: " << ra.pagesPrefetched << "\n";
+                std::cout << "  Prefetch Hits: " << ra.prefetchHits << "\n";
+                std::cout << "  Wasted Prefetches (evicted or freed unused): " << ra.wastedPrefetches << "\n";
+                std::cout << "  Accuracy: " << std::fixed << std::setprecision(2) << ra.accuracy() * 100 << "%\n";
+                std::cout.unsetf(std::ios::fixed);
+            }
+            if (contiguousAllocator) {
+                std::lock_guard<std::mutex> lock(memoryMutex);
+                const ContiguousStatistics& mem = contiguousAllocator->statistics();
+                std::cout << "\nContiguous Memory (" << contiguousAllocator->name() << "):\n";
+                std::cout << "  Processes Placed: " << mem.processes << "\n";
+                std::cout << "  Held: " << mem.heldBytes << "/" << mem.totalBytes << " bytes ("
+                          << std::fixed << std::setprecision(2) << mem.utilization() * 100 << "%)\n";
+                std::cout.unsetf(std::ios::fixed);
+                std::cout << "  Free Blocks: " << mem.freeBlocks << " (largest " << mem.largestFreeBlock << " bytes)\n";
+                std::cout << "  External Fragmentation: " << mem.externalFragmentation() << " bytes\n";
+                std::cout << "  Internal Fragmentation: " << mem.internalFragmentation() << " bytes\n";
+                std::cout << "  Deferred Placements: " << mem.failedAllocations << "\n";
+            }
+            CopyOnWriteStatistics cow = demandPagingAllocator.getCopyOnWriteStatistics();
+            if (cow.clones > 0) {
+                std::cout << "\nCopy-on-write:\n";
+                std::cout << "  Clones: " << cow.clones << " (" << cow.framesShared << " frames shared at clone time)\n";
+                std::cout << "  Shared Frames: " << cow.sharedFrames << " (" << cow.mappingsSaved << " copies avoided)\n";
+                std::cout << "  Copies on Write: " << cow.copies << " (" << std::fixed << std::setprecision(2)
+                          << cow.copyRatio() * 100 << "% of shared mappings)\n";
+                std::cout.unsetf(std::ios::fixed);
+            }
+            if (demandPagingAllocator.zeroFrameNumber() != -1) {
+                DedupStatistics dedup = demandPagingAllocator.getDedupStatistics();
+                std::cout << "\nZero Page and Dedup";
+                if (config.dedup_scan_pages > 0) {
+                    std::cout << " (" << config.dedup_scan_pages << " pages every " << config.dedup_sleep_ms << " ms)";
+                }
+                std::cout << ":\n";
+                std::cout << "  Zero Page Mappings: " << dedup.zeroMappings << " (" << dedup.zeroFills
+                          << " read faults served, " << dedup.zeroCopies << " copied on first write)\n";
+                if (config.dedup_scan_pages > 0) {
+                    std::cout << "  Pages Hashed: " << dedup.pagesScanned << " in " << dedup.passes << " passes\n";
+                    std::cout << "  Frames Merged: " << dedup.merges << " (" << dedup.zeroMerges << " into the zero page, "
+                              << std::fixed << std::setprecision(2) << dedup.mergeRatio() * 100 << "% of pages hashed)\n";
+                    std::cout.unsetf(std::ios::fixed);
+                }
+                std::cout << "  Frames Saved: " << dedup.zeroMappings + cow.mappingsSaved << "\n";
+            }
+            SwapUsage swap = demandPagingAllocator.getSwapUsage();
+            std::cout << "\nBacking Store (" << config.backing_store_size << " bytes):\n";
+            std::cout << "  Used: " << swap.slotsUsed << "/" << swap.capacitySlots << " pages ("
+                      << static_cast<long long>(swap.slotsUsed) * swap.pageSize << " bytes, "
+                      << std::fixed << std::setprecision(2) << swap.utilization() * 100 << "%)\n";
+            std::cout.unsetf(std::ios::fixed);
+            std::cout << "  Peak: " << swap.peakSlots << " pages\n";
+            std::cout << "  Out-of-swap Refusals: " << swap.outOfSwap << "\n";
+            std::cout << "  File I/O: " << swap.fileReads << " pages read, " << swap.fileWrites << " pages written\n";
+            if (config.compressed_swap_size > 0) {
+                CompressedSwapStatistics zs = demandPagingAllocator.getCompressedSwapStatistics();
+                std::cout << "\nCompressed Swap (" << zs.budgetBytes << " bytes):\n";
+                std::cout << std::fixed << std::setprecision(2);
+                std::cout << "  Held: " << zs.pagesHeld << " pages in " << zs.bytesHeld << " bytes ("
+                          << (zs.budgetBytes > 0 ? 100.0 * zs.bytesHeld / zs.budgetBytes : 0.0) << "% of budget)\n";
+                std::cout << "  Compression Ratio: " << zs.compressionRatio() << ":1 over " << zs.stores << " pages stored\n";
+                std::cout << "  Hit Rate: " << zs.hitRate() * 100 << "% (" << zs.hits << " of " << zs.loads << " swap-ins)\n";
+                std::cout.unsetf(std::ios::fixed);
+                std::cout << "  Spilled to File: " << zs.spills << " (full), " << zs.rejected << " (incompressible)\n";
+            }
+            if (demandPagingAllocator.numTlbs() > 0) {
+                std::cout << "\nPer-core TLB (" << config.tlb_entries << " entries):\n";
+                std::cout << "Core |   TLB Hits |   Misses | Hit Rate | Flushes\n";
+                std::cout << "-----|------------|----------|----------|--------\n";
+                for (int i = 0; i < demandPagingAllocator.numTlbs(); ++i) {
+                    const CoreTlb& tlb = demandPagingAllocator.coreTlb(i);
+                    long long hits = tlb.hits, misses = tlb.misses;
+                    double rate = hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0;
+                    std::cout << std::setw(4) << i << " | "
+                              << std::setw(10) << hits << " | "
+                              << std::setw(8) << misses << " | "
+                              << std::fixed << std::setprecision(2) << std::setw(7) << rate << "% | "
+                              << std::setw(7) << tlb.flushes << "\n";
+                    std::cout.unsetf(std::ios::fixed);
+                }
             }
             std::cout << "===================\n\n";
         }
         else if (cmd == "test-pagetable") {
-            int testPid = next_pid++;
-            processNames[testPid] = "test_process";
-            Session s;
-            s.start = Clock::now();
-            s.finished = false;
-            s.memorySize = 1024;
-            sessions[testPid] = std::move(s);
-            
-            createProcessMemoryLayout(testPid, 1024);
+            int testPid = nextPid++;
+            nameProcess(testPid, "test_process");
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                Session s;
+                s.start = Clock::now();
+                s.finished = false;
+                s.memorySize = 1024;
+                sessions[testPid] = std::move(s);
+                
+                createProcessMemoryLayout(testPid, 1024);
+            }
             
             std::cout << "\nSimulating memory accesses...\n";
-            writeMemory(testPid, 0x0, 42);
-            writeMemory(testPid, 0x10, 123);
-            writeMemory(testPid, 0x20, 456);
+            // Past the symbol_table segment, which holds the variables
+            writeMemory(testPid, SYMBOL_TABLE_SIZE, 42);
+            writeMemory(testPid, SYMBOL_TABLE_SIZE + 0x10, 123);
+            writeMemory(testPid, SYMBOL_TABLE_SIZE + 0x20, 456);
             int value;
-            readMemory(testPid, 0x0, value);
+            readMemory(testPid, SYMBOL_TABLE_SIZE, value);
             
             std::cout << "\nPage Table after memory accesses:\n";
             displayPageTable(testPid);
         }
+        else if (cmd == "test-generator") {
+            // A fixed seed generates the same program every run; the MULs
+            // appended to it square var0 far past the variable range
+            std::mt19937 rng(1729);
+            const int memorySize = 1024;
+            std::vector<Instruction> instructions = generateRandomProgram(rng, 200, memorySize);
+            instructions.emplace_back(InstructionType::DECLARE, std::vector<std::string>{"var0", "89"});
+            for (int i = 0; i < 8; ++i) {
+                instructions.emplace_back(InstructionType::MUL, std::vector<std::string>{"var0", "var0", "var0"});
+            }
+            std::shared_ptr<Program> program = std::make_shared<Program>();
+            if (!compileProgram(instructions, memorySize, *program)) {
+                std::cout << "FAILED: the generated program did not compile.\n";
+                continue;
+            }
+            
+            int testPid = nextPid++;
+            nameProcess(testPid, "test_generator");
+            Session* session;
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                Session s;
+                s.start = Clock::now();
+                s.finished = false;
+                s.memorySize = memorySize;
+                s.instructions = instructions;
+                s.program = program;
+                sessions[testPid] = std::move(s);
+                session = &sessions[testPid];
+                
+                createProcessMemoryLayout(testPid, memorySize, false);
+            }
+            
+            // Never submitted, so no core runs it alongside this thread
+            std::ostringstream trace;
+            int executed = 0;
+            while (executed < static_cast<int>(program->code.size()) &&
+                   executeBytecodeOp(testPid, *session, program->code[executed], trace)) {
+                ++executed;
+            }
+            bool inRange = true;
+            for (int slot = 0; slot < static_cast<int>(program->symbols.size()); ++slot) {
+                int value = 0;
+                if (session->variables.isDeclared(slot) && readMemory(testPid, symbolAddress(slot), value)) {
+                    inRange = inRange && value >= 0 && value <= VARIABLE_MAX;
+                }
+            }
+            int var0 = 0;
+            readMemory(testPid, symbolAddress(0), var0);
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                session->finished = true;
+            }
+            
+            if (executed < static_cast<int>(program->code.size())) {
+                std::cout << "FAILED: stopped at instruction " << (executed + 1) << " of "
+                          << program->code.size() << ".\n";
+            } else if (!inRange || var0 != VARIABLE_MAX) {
+                std::cout << "FAILED: a variable left 0.." << VARIABLE_MAX << " (var0 = " << var0 << ").\n";
+            } else {
+                std::cout << "Generated program ran all " << executed << " instructions; every variable stayed in 0.."
+                          << VARIABLE_MAX << " and var0 saturated at " << var0 << ".\n";
+            }
+        }
+        else if (cmd == "trace-start" || cmd.rfind("trace-start ", 0) == 0) {
+            std::string path = cmd.size() > 11 ? trim(cmd.substr(11)) : "csopesy-page-trace.bin";
+            if (pageTraceRecorder.active()) {
+                std::cout << "A page trace is already being recorded. Use 'trace-stop' first.\n";
+            } else if (pageTraceRecorder.start(path, config.mem_per_frame, config.num_frames)) {
+                std::cout << "Recording page accesses to " << path << ".\n";
+            }
+        }
+        else if (cmd == "trace-stop") {
+            if (!pageTraceRecorder.active()) {
+                std::cout << "No page trace is being recorded.\n";
+            } else {
+                long long records = pageTraceRecorder.stop();
+                std::cout << "Page trace closed (" << records << " records). Replay it with pager_replay.\n";
+            }
+        }
         else if (cmd == "frametable") {
             demandPagingAllocator.displayFrameTable();
         } 
+        else if (cmd == "fault-latency") {
+            displayFaultLatency();
+        }
+        else if (cmd == "fault-latency-reset") {
+            demandPagingAllocator.resetFaultLatency();
+            std::cout << "Fault latency histograms cleared.\n";
+        }
         else if (cmd == "process-smi") {
             displayProcessSmi();
         }
@@ -424,27 +848,33 @@ int main() {
                 targetPid = std::stoi(targetStr);
             } catch (const std::exception&) {
                 // If not a number, search by process name
-                for (const auto& pair : processNames) {
-                    if (pair.second == targetStr) {
-                        targetPid = pair.first;
-                        break;
-                    }
-                }
+                targetPid = findProcessByName(targetStr);
             }
             
-            if (targetPid == -1 || sessions.find(targetPid) == sessions.end()) {
+            bool found = false;
+            int memorySize = 0, numPages = 0;
+            {
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                auto it = sessions.find(targetPid);
+                if (it != sessions.end()) {
+                    found = true;
+                    memorySize = it->second.memorySize;
+                    numPages = it->second.memoryLayout ? it->second.memoryLayout->pageTable.numPages : 0;
+                }
+            }
+            if (!found) {
                 std::cout << "Error: No such process found.\n";
                 std::cout << "Usage: screen -r <pid|name>\n";
                 continue;
             }
             
             // Now we have a valid PID, show the process information and output
-            std::cout << "Process name: " << processNames[targetPid] << "\n";
+            std::cout << "Process name: " << processName(targetPid) << "\n";
             std::cout << "ID: " << targetPid << "\n";
-            std::cout << "Memory size: " << sessions[targetPid].memorySize << " bytes\n";
+            std::cout << "Memory size: " << memorySize << " bytes\n";
             
-            if (sessions[targetPid].memoryLayout) {
-                std::cout << "Pages needed: " << sessions[targetPid].memoryLayout->pageTable.numPages << "\n";
+            if (numPages > 0) {
+                std::cout << "Pages needed: " << numPages << "\n";
             }
             
             std::cout << "\nProcess output:\n";
@@ -459,18 +889,24 @@ int main() {
         else if (cmd == "help") {
             std::cout << "\nAvailable Commands:\n";
             std::cout << "  initialize                    - Initialize the system\n";
-            std::cout << "  scheduler-test               - Start the scheduler test\n";
-            std::cout << "  scheduler-stop               - Stop the scheduler\n";
+            std::cout << "  scheduler-test               - Start scheduling and generating processes\n";
+            std::cout << "  scheduler-stop               - Stop generating and drain running processes\n";
             std::cout << "  screen -s <name> [mem_size]  - Create a new process\n";
             std::cout << "  screen -c <name> <mem> \"ins\" - Create a new process with instructions\n";
             std::cout << "  screen -ls                   - List all processes\n";
+            std::cout << "  clone <pid|name> <name> [n]  - Start n copy-on-write clones of a process\n";
             std::cout << "  pagetable <pid>              - Show page table for process\n";
             std::cout << "  segments <pid>               - Show memory segments for process\n";
             std::cout << "  test-pagetable               - Run page table creation tests\n";
+            std::cout << "  test-generator               - Run a fixed generated program that overflows int\n";
             std::cout << "  frametable                   - Display physical frame table\n";
+            std::cout << "  trace-start [file]           - Record page accesses to a binary trace\n";
+            std::cout << "  trace-stop                   - Stop recording the page trace\n";
             std::cout << "  report-util                  - Generate utilization report\n";
             std::cout << "  report-mem                   - Generate memory report\n";
-            std::cout << "  vmstat                       - Show CPU tick statistics (active/idle, per-process)\n";
+            std::cout << "  vmstat                       - Show CPU tick and per-core run queue statistics\n";
+            std::cout << "  fault-latency                - Show p50/p90/p99/max page-fault latencies\n";
+            std::cout << "  fault-latency-reset          - Clear the page-fault latency histograms\n";
             std::cout << "  help                         - Show this help message\n";
             std::cout << "  exit                         - Exit the program\n\n";
         }
@@ -480,11 +916,12 @@ int main() {
     }
     
     stopScheduler = true;
-    for (int i = 0; i < config.num_cpu; ++i)
-        coreCVs[i].notify_all();
+    if (generator.joinable()) generator.join();
     if (scheduler.joinable()) scheduler.join();
     for (auto &t : workers)
         if (t.joinable()) t.join();
+    demandPagingAllocator.shutdown();
+    pageTraceRecorder.stop();
 
     return 0;
 }
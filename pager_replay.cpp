@@ -0,0 +1,153 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "src/page_replacement.h"
+#include "src/page_trace.h"
+
+// Replays a page trace recorded with 'trace-start' through several
+// replacement policies at once, one thread per policy, and prints their
+// fault counts next to Belady's optimum for the same access sequence.
+//
+//   pager_replay <trace> [frames] [policy,policy,...]
+//
+// frames defaults to the frame count the trace was recorded with; policies
+// default to every online policy plus opt.
+
+struct PageAccess {
+    int processId;
+    int pageNumber;
+    bool isWrite;
+    bool isExit;
+};
+
+struct ReplayResult {
+    std::string policy;
+    PagingStatistics stats;
+    double elapsedMs = 0;
+};
+
+static std::vector<std::string> splitPolicies(const std::string& list) {
+    std::vector<std::string> names;
+    std::stringstream ss(list);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        if (!name.empty()) names.push_back(name);
+    }
+    return names;
+}
+
+// For each access, the index of the next access to the same page, or
+// "never" if the page is not touched again before its process exits.
+static std::vector<long long> computeNextUse(const std::vector<PageAccess>& accesses) {
+    const long long never = std::numeric_limits<long long>::max();
+    std::vector<long long> nextUse(accesses.size(), never);
+    std::unordered_map<PageKey, long long> upcoming;
+    for (long long i = static_cast<long long>(accesses.size()) - 1; i >= 0; --i) {
+        const PageAccess& access = accesses[i];
+        if (access.isExit) continue;
+        PageKey key = makePageKey(access.processId, access.pageNumber);
+        auto it = upcoming.find(key);
+        if (it != upcoming.end()) nextUse[i] = it->second;
+        upcoming[key] = i;
+    }
+    return nextUse;
+}
+
+static void replay(const std::vector<PageAccess>& accesses, const std::vector<long long>& nextUse,
+                   int numFrames, ReplayResult& result) {
+    auto started = std::chrono::steady_clock::now();
+
+    BeladyReplacement* optimal = nullptr;
+    std::unique_ptr<ReplacementPolicy> policy;
+    if (result.policy == "opt") {
+        optimal = new BeladyReplacement(nextUse);
+        policy.reset(optimal);
+    } else {
+        policy = createReplacementPolicy(result.policy);
+    }
+
+    PageCacheSimulator simulator(std::move(policy), numFrames);
+    for (size_t i = 0; i < accesses.size(); ++i) {
+        const PageAccess& access = accesses[i];
+        if (access.isExit) {
+            simulator.releaseProcess(access.processId);
+            continue;
+        }
+        if (optimal) optimal->setCursor(static_cast<long long>(i));
+        simulator.access(access.processId, access.pageNumber, access.isWrite);
+    }
+
+    result.stats = simulator.statistics();
+    result.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace> [frames] [policy,policy,...]\n";
+        return 1;
+    }
+
+    TraceHeader header;
+    std::vector<TraceRecord> records;
+    if (!readPageTrace(argv[1], header, records)) return 1;
+
+    int numFrames = header.numFrames;
+    if (argc >= 3) {
+        try {
+            numFrames = std::stoi(argv[2]);
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid frame count '" << argv[2] << "'\n";
+            return 1;
+        }
+    }
+    if (numFrames <= 0) {
+        std::cerr << "Error: Frame count must be positive\n";
+        return 1;
+    }
+
+    std::vector<std::string> policies = replacementPolicyNames();
+    policies.push_back("opt");
+    if (argc >= 4) policies = splitPolicies(argv[3]);
+
+    std::vector<PageAccess> accesses;
+    accesses.reserve(records.size());
+    for (const auto& record : records) {
+        PageAccess access;
+        access.processId = static_cast<int>(record.processId);
+        access.pageNumber = record.address() / header.pageSize;
+        access.isWrite = record.isWrite();
+        access.isExit = record.isExit();
+        accesses.push_back(access);
+    }
+    std::vector<long long> nextUse = computeNextUse(accesses);
+
+    std::vector<ReplayResult> results(policies.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < policies.size(); ++i) {
+        results[i].policy = policies[i];
+        threads.emplace_back(replay, std::cref(accesses), std::cref(nextUse), numFrames, std::ref(results[i]));
+    }
+    for (auto& t : threads) t.join();
+
+    std::cout << "Trace: " << argv[1] << " (" << records.size() << " records, page size "
+              << header.pageSize << " bytes)\n";
+    std::cout << "Frames: " << numFrames << "\n\n";
+    std::cout << "Policy     |  Page Faults | Replacements | Write-backs | Hit Ratio |   Time (ms)\n";
+    std::cout << "-----------|--------------|--------------|-------------|-----------|------------\n";
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(10) << result.policy << std::right << " | "
+                  << std::setw(12) << result.stats.pageFaults << " | "
+                  << std::setw(12) << result.stats.pageReplacements << " | "
+                  << std::setw(11) << result.stats.dirtyWritebacks << " | "
+                  << std::fixed << std::setprecision(2) << std::setw(8) << result.stats.hitRatio() * 100 << "% | "
+                  << std::setw(11) << result.elapsedMs << "\n";
+        std::cout.unsetf(std::ios::fixed);
+    }
+    return 0;
+}
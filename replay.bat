@@ -0,0 +1,5 @@
+@echo off
+REM Compile the offline pager replay tool
+g++ pager_replay.cpp src\page_replacement.cpp src\page_trace.cpp -o pager_replay.exe -std=c++14 -pthread
+REM Replay the given trace, e.g. replay.bat csopesy-page-trace.bin 64
+pager_replay.exe %*
@@ -0,0 +1,266 @@
+#include "backing_store.h"
+#include "config.h"
+#include <algorithm>
+#include <iostream>
+
+BackingStore::BackingStore(const std::string& filename)
+    : path(filename), pageSize(0), capacitySlots(0), nextSlot(0), peakSlots(0), outOfSwap(0),
+      fileReads(0), fileWrites(0) {}
+
+// Opened on first use because the page size is only known once config.txt
+// has been read. Any file left over from an earlier run is discarded.
+bool BackingStore::openLocked() {
+    if (file.is_open()) return true;
+    pageSize = config.mem_per_frame;
+    capacitySlots = std::max(0, config.backing_store_size / pageSize);
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error: Cannot open backing store file " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+int BackingStore::findSlotLocked(int processId, int pageNumber) const {
+    auto it = slotsByProcess.find(processId);
+    if (it == slotsByProcess.end() || pageNumber >= static_cast<int>(it->second.size())) return -1;
+    return it->second[pageNumber];
+}
+
+// An unmapped slot, or -1 if swap is full.
+int BackingStore::newSlotLocked() {
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (nextSlot < capacitySlots) {
+        slot = nextSlot++;
+        slotRefs.push_back(0);
+    } else {
+        outOfSwap++;
+        return -1;
+    }
+    peakSlots = std::max(peakSlots, nextSlot - static_cast<int>(freeSlots.size()));
+    return slot;
+}
+
+void BackingStore::mapSlotLocked(int processId, int pageNumber, int slot) {
+    auto& pages = slotsByProcess[processId];
+    if (pageNumber >= static_cast<int>(pages.size())) pages.resize(pageNumber + 1, -1);
+    pages[pageNumber] = slot;
+    slotRefs[slot]++;
+}
+
+void BackingStore::dropSlotLocked(int slot) {
+    if (--slotRefs[slot] > 0) return;
+    compressed.drop(slot);
+    freeSlots.push_back(slot);
+}
+
+// The page's slot if it is the only one mapping it, otherwise a fresh one.
+int BackingStore::assignSlotLocked(int processId, int pageNumber) {
+    int slot = findSlotLocked(processId, pageNumber);
+    if (slot != -1 && slotRefs[slot] == 1) return slot;
+
+    int fresh = newSlotLocked();
+    if (fresh == -1) return -1;
+    if (slot != -1) dropSlotLocked(slot);
+    mapSlotLocked(processId, pageNumber, fresh);
+    return fresh;
+}
+
+// Keeps the slot's page in the compressed tier, writing the pages the tier
+// pushes out to make room to the file. False if the page has to go to the
+// file itself.
+bool BackingStore::compressLocked(int slot, const char* data) {
+    return compressed.store(slot, data, [this](int spilled, const char* page) {
+        writeFileLocked(spilled, page, 1);
+    });
+}
+
+// Writes count pages to consecutive slots from slot on. The caller checks
+// the stream once it is done.
+void BackingStore::writeFileLocked(int slot, const char* data, int count) {
+    file.seekp(static_cast<std::streamoff>(slot) * pageSize);
+    file.write(data, static_cast<std::streamsize>(count) * pageSize);
+    fileWrites += count;
+}
+
+bool BackingStore::reserveSlot(int processId, int pageNumber) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!openLocked()) return false;
+    return assignSlotLocked(processId, pageNumber) != -1;
+}
+
+bool BackingStore::storePage(int processId, int pageNumber, const char* data) {
+    return storePages(processId, pageNumber, 1, data);
+}
+
+bool BackingStore::storePages(int processId, int firstPage, int count, const char* data) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!openLocked()) return false;
+
+    std::vector<int> slots(count);
+    for (int i = 0; i < count; ++i) {
+        slots[i] = assignSlotLocked(processId, firstPage + i);
+        if (slots[i] == -1) return false;
+    }
+
+    file.clear();
+    long long writesBefore = fileWrites;
+    std::vector<bool> kept(count);
+    for (int i = 0; i < count; ++i) kept[i] = compressLocked(slots[i], data + static_cast<size_t>(i) * pageSize);
+    for (int i = 0; i < count;) {
+        if (kept[i]) {
+            ++i;
+            continue;
+        }
+        int run = 1;
+        while (i + run < count && !kept[i + run] && slots[i + run] == slots[i] + run) ++run;
+        writeFileLocked(slots[i], data + static_cast<size_t>(i) * pageSize, run);
+        i += run;
+    }
+    if (fileWrites != writesBefore) file.flush();
+    if (!file) {
+        std::cerr << "Error: Failed to write pages " << firstPage << "-" << (firstPage + count - 1)
+                  << " of process " << processId << " to backing store\n";
+        return false;
+    }
+    return true;
+}
+
+bool BackingStore::storeShared(const std::vector<std::pair<int, int>>& pages, const char* data) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!openLocked() || pages.empty()) return false;
+
+    // Overwritten in place if exactly these pages share the slot already
+    int slot = findSlotLocked(pages[0].first, pages[0].second);
+    bool exclusive = slot != -1 && slotRefs[slot] == static_cast<int>(pages.size());
+    for (size_t i = 1; exclusive && i < pages.size(); ++i) {
+        exclusive = findSlotLocked(pages[i].first, pages[i].second) == slot;
+    }
+    if (!exclusive) {
+        slot = newSlotLocked();
+        if (slot == -1) return false;
+        for (const auto& page : pages) {
+            int old = findSlotLocked(page.first, page.second);
+            if (old != -1) dropSlotLocked(old);
+            mapSlotLocked(page.first, page.second, slot);
+        }
+    }
+
+    file.clear();
+    long long writesBefore = fileWrites;
+    if (!compressLocked(slot, data)) writeFileLocked(slot, data, 1);
+    if (fileWrites != writesBefore) file.flush();
+    if (!file) {
+        std::cerr << "Error: Failed to write shared page " << pages[0].second << " of process "
+                  << pages[0].first << " to backing store\n";
+        return false;
+    }
+    return true;
+}
+
+bool BackingStore::loadPage(int processId, int pageNumber, char* data) {
+    return loadPages(processId, pageNumber, 1, data);
+}
+
+// A page that was never swapped out reads back as zeros. Pages in the
+// compressed tier are decompressed; the file is only read for the rest.
+bool BackingStore::loadPages(int processId, int firstPage, int count, char* data) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (!openLocked()) return false;
+
+    file.clear();
+    for (int i = 0; i < count;) {
+        char* out = data + static_cast<size_t>(i) * pageSize;
+        int slot = findSlotLocked(processId, firstPage + i);
+        if (slot == -1) {
+            std::fill(out, out + pageSize, 0);
+            ++i;
+            continue;
+        }
+        if (compressed.load(slot, out)) {
+            ++i;
+            continue;
+        }
+        int run = 1;
+        while (i + run < count && findSlotLocked(processId, firstPage + i + run) == slot + run &&
+               !compressed.holds(slot + run)) {
+            ++run;
+        }
+        compressed.noteFileLoads(run);
+        file.seekg(static_cast<std::streamoff>(slot) * pageSize);
+        file.read(out, static_cast<std::streamsize>(run) * pageSize);
+        fileReads += run;
+        if (!file) {
+            std::cerr << "Error: Failed to read page " << (firstPage + i) << " of process " << processId
+                      << " from backing store\n";
+            return false;
+        }
+        i += run;
+    }
+    return true;
+}
+
+void BackingStore::releaseProcess(int processId) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = slotsByProcess.find(processId);
+    if (it == slotsByProcess.end()) return;
+    for (int slot : it->second) {
+        if (slot != -1) dropSlotLocked(slot);
+    }
+    slotsByProcess.erase(it);
+}
+
+void BackingStore::cloneProcess(int parentId, int childId) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    auto it = slotsByProcess.find(parentId);
+    if (it == slotsByProcess.end()) return;
+    std::vector<int> slots = it->second;
+    for (int page = 0; page < static_cast<int>(slots.size()); ++page) {
+        if (slots[page] != -1) mapSlotLocked(childId, page, slots[page]);
+    }
+}
+
+void BackingStore::reset() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    if (file.is_open()) file.close();
+    freeSlots.clear();
+    slotRefs.clear();
+    slotsByProcess.clear();
+    nextSlot = 0;
+    peakSlots = 0;
+    outOfSwap = 0;
+    fileReads = 0;
+    fileWrites = 0;
+    compressed.reset(config.compressed_swap_size, config.mem_per_frame);
+}
+
+bool BackingStore::holdsPage(int processId, int pageNumber) {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return findSlotLocked(processId, pageNumber) != -1;
+}
+
+int BackingStore::pagesStored() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return nextSlot - static_cast<int>(freeSlots.size());
+}
+
+SwapUsage BackingStore::usage() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    SwapUsage snapshot;
+    snapshot.pageSize = config.mem_per_frame;
+    snapshot.slotsUsed = nextSlot - static_cast<int>(freeSlots.size());
+    snapshot.peakSlots = peakSlots;
+    snapshot.capacitySlots = std::max(0, config.backing_store_size / config.mem_per_frame);
+    snapshot.outOfSwap = outOfSwap;
+    snapshot.fileReads = fileReads;
+    snapshot.fileWrites = fileWrites;
+    return snapshot;
+}
+
+CompressedSwapStatistics BackingStore::compressedStatistics() {
+    std::lock_guard<std::mutex> lock(storeMutex);
+    return compressed.statistics();
+}
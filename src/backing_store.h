@@ -0,0 +1,97 @@
+#ifndef BACKING_STORE_H
+#define BACKING_STORE_H
+
+#include "compressed_swap.h"
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Swap space kept in a binary file of fixed-size page slots. Every
+// (process, page) pair that has been swapped out owns one slot, found
+// through an in-memory index, so a store or load is a single seek plus one
+// page-sized read or write no matter how much has been swapped before.
+// Slots freed by finished processes are reused before the file grows.
+// A cloned process shares its parent's slots; a slot is only freed when
+// its last page lets go of it, and storing a page whose slot is shared
+// moves that page to a slot of its own first.
+//
+// Nothing is allocated until a page is first stored, and the file never
+// holds more than backing-store-size bytes. When every slot is taken, a
+// store of a page that has no slot yet fails and is counted; the pager
+// then only evicts pages that need no write.
+//
+// With compressed-swap-size set, a slot's page is compressed into memory
+// first and only reaches the file when the compressed tier runs out of
+// room or the page does not compress. Slots are assigned either way, so
+// the tier never changes how much can be swapped out.
+struct SwapUsage {
+    int pageSize = 0;
+    int slotsUsed = 0;
+    int peakSlots = 0;
+    int capacitySlots = 0;
+    long long outOfSwap = 0;   // stores refused because every slot was taken
+    long long fileReads = 0;   // pages read from the file
+    long long fileWrites = 0;  // pages written to the file
+
+    double utilization() const { return capacitySlots > 0 ? static_cast<double>(slotsUsed) / capacitySlots : 0.0; }
+};
+
+class BackingStore {
+private:
+    std::string path;
+    std::fstream file;
+    std::mutex storeMutex;
+    int pageSize;
+    int capacitySlots;
+    int nextSlot;
+    int peakSlots;
+    long long outOfSwap;
+    long long fileReads;
+    long long fileWrites;
+    CompressedSwapCache compressed;
+    std::vector<int> freeSlots;
+    std::vector<int> slotRefs;   // slot -> pages mapping it
+    std::unordered_map<int, std::vector<int>> slotsByProcess;   // pid -> page -> slot (-1 if none)
+
+    bool openLocked();
+    int findSlotLocked(int processId, int pageNumber) const;
+    int newSlotLocked();
+    void mapSlotLocked(int processId, int pageNumber, int slot);
+    void dropSlotLocked(int slot);
+    int assignSlotLocked(int processId, int pageNumber);
+    bool compressLocked(int slot, const char* data);
+    void writeFileLocked(int slot, const char* data, int count);
+
+public:
+    explicit BackingStore(const std::string& filename = "csopesy-backing-store.bin");
+
+    // Claims a slot for the page ahead of a later store, so that store
+    // cannot run out of swap. False if the store is full.
+    bool reserveSlot(int processId, int pageNumber);
+    bool storePage(int processId, int pageNumber, const char* data);
+    // Stores count consecutive pages of one process from one buffer. Pages
+    // whose slots are adjacent in the file go out in a single write.
+    bool storePages(int processId, int firstPage, int count, const char* data);
+    // Stores one page's contents for every (pid, page) in pages, leaving
+    // them all on one slot that nothing else maps.
+    bool storeShared(const std::vector<std::pair<int, int>>& pages, const char* data);
+    bool loadPage(int processId, int pageNumber, char* data);
+    // Loads count consecutive pages of one process into one buffer, reading
+    // each run of adjacent slots in a single call.
+    bool loadPages(int processId, int firstPage, int count, char* data);
+    // False for a page that has no slot: it was never stored and reads
+    // back as zeros.
+    bool holdsPage(int processId, int pageNumber);
+    // The child's pages map the same slots as the parent's.
+    void cloneProcess(int parentId, int childId);
+    void releaseProcess(int processId);
+    void reset();
+    int pagesStored();
+    SwapUsage usage();
+    CompressedSwapStatistics compressedStatistics();
+};
+
+#endif // BACKING_STORE_H
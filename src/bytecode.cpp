@@ -0,0 +1,289 @@
+#include "bytecode.h"
+#include "instruction.h"
+#include "memory_manager.h"
+#include "utils.h"
+#include <iostream>
+#include <map>
+
+namespace {
+
+class ProgramBuilder {
+public:
+    ProgramBuilder(Program& target, int memSize) : program(target), memorySize(memSize) {}
+
+    // Assigns the next free symbol-table slot; -1 once the table is full.
+    int slotFor(const std::string& name) {
+        auto it = slotIndex.find(name);
+        if (it != slotIndex.end()) return it->second;
+        int slot = static_cast<int>(program.symbols.size());
+        if (slot >= MAX_SYMBOLS || symbolAddress(slot) + SYMBOL_SLOT_SIZE > memorySize) {
+            std::cerr << "Error: Symbol table full, cannot declare '" << name << "' (max "
+                      << MAX_SYMBOLS << " variables)\n";
+            return -1;
+        }
+        slotIndex[name] = slot;
+        program.symbols.push_back(name);
+        return slot;
+    }
+
+    int intern(const std::string& text) {
+        auto it = stringIndex.find(text);
+        if (it != stringIndex.end()) return it->second;
+        int index = static_cast<int>(program.strings.size());
+        stringIndex[text] = index;
+        program.strings.push_back(text);
+        return index;
+    }
+
+    bool operand(const std::string& token, OperandRef& ref) {
+        if (isValidVariableName(token)) {
+            ref.isSlot = true;
+            ref.value = slotFor(token);
+            return ref.value >= 0;
+        }
+        try {
+            ref.isSlot = false;
+            ref.value = std::stoi(token);
+            return true;
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid operand '" << token << "'\n";
+            return false;
+        }
+    }
+
+private:
+    Program& program;
+    int memorySize;
+    std::map<std::string, int> slotIndex;
+    std::map<std::string, int> stringIndex;
+};
+
+std::string unquote(const std::string& text) {
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+// PRINT(x) prints x's value, PRINT("a" + x) appends x's value to the literal,
+// and anything else prints as text. An undeclared variable prints its name.
+bool lowerPrint(ProgramBuilder& builder, const std::string& content, BytecodeOp& op) {
+    if (isValidVariableName(content)) {
+        op.slot = builder.slotFor(content);
+        op.fallback = builder.intern(content);
+        return op.slot >= 0;
+    }
+
+    size_t plusPos = content.find(" + ");
+    if (plusPos != std::string::npos) {
+        std::string leftPart = unquote(trim(content.substr(0, plusPos)));
+        std::string rightPart = trim(content.substr(plusPos + 3));
+        if (isValidVariableName(rightPart)) {
+            op.text = builder.intern(leftPart);
+            op.slot = builder.slotFor(rightPart);
+            op.fallback = builder.intern(rightPart);
+            return op.slot >= 0;
+        }
+        op.text = builder.intern(leftPart + rightPart);
+        return true;
+    }
+
+    op.text = builder.intern(unquote(content));
+    return true;
+}
+
+bool loadSlot(int processId, int slot, int& value) {
+    if (!readMemory(processId, symbolAddress(slot), value)) {
+        std::cerr << "Error: Failed to read memory at address " << symbolAddress(slot) << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool storeSlot(int processId, Session& session, int slot, int value) {
+    if (!writeMemory(processId, symbolAddress(slot), value)) {
+        std::cerr << "Error: Failed to write memory at address " << symbolAddress(slot) << "\n";
+        return false;
+    }
+    session.variables.markDeclared(slot);
+    return true;
+}
+
+bool operandValue(int processId, Session& session, const Program& program, const OperandRef& ref, int& value) {
+    if (!ref.isSlot) {
+        value = ref.value;
+        return true;
+    }
+    if (!session.variables.isDeclared(ref.value)) {
+        std::cerr << "Error: Invalid operand '" << program.symbols[ref.value] << "'\n";
+        return false;
+    }
+    return loadSlot(processId, ref.value, value);
+}
+
+} // namespace
+
+bool compileProgram(const std::vector<Instruction>& instructions, int memorySize, Program& program) {
+    program = Program();
+    program.code.reserve(instructions.size());
+    ProgramBuilder builder(program, memorySize);
+
+    for (const auto& instruction : instructions) {
+        BytecodeOp op;
+        const auto& operands = instruction.operands;
+        try {
+            switch (instruction.type) {
+                case InstructionType::DECLARE:
+                    op.op = OpCode::DECLARE;
+                    op.slot = builder.slotFor(operands[0]);
+                    op.lhs.value = std::stoi(operands[1]);
+                    if (op.slot < 0) return false;
+                    break;
+                case InstructionType::ADD:
+                case InstructionType::SUB:
+                case InstructionType::MUL:
+                case InstructionType::DIV:
+                    op.op = instruction.type == InstructionType::ADD ? OpCode::ADD
+                          : instruction.type == InstructionType::SUB ? OpCode::SUB
+                          : instruction.type == InstructionType::MUL ? OpCode::MUL
+                          : OpCode::DIV;
+                    op.slot = builder.slotFor(operands[0]);
+                    if (op.slot < 0 || !builder.operand(operands[1], op.lhs) ||
+                        !builder.operand(operands[2], op.rhs)) {
+                        return false;
+                    }
+                    break;
+                case InstructionType::WRITE:
+                    op.op = OpCode::WRITE;
+                    op.address = hexToInt(operands[0]);
+                    op.slot = builder.slotFor(operands[1]);
+                    op.text = builder.intern(operands[0]);
+                    if (op.slot < 0) return false;
+                    break;
+                case InstructionType::READ:
+                    op.op = OpCode::READ;
+                    op.slot = builder.slotFor(operands[0]);
+                    op.address = hexToInt(operands[1]);
+                    op.text = builder.intern(operands[1]);
+                    if (op.slot < 0) return false;
+                    break;
+                case InstructionType::PRINT:
+                    op.op = OpCode::PRINT;
+                    if (!lowerPrint(builder, operands[0], op)) return false;
+                    break;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error compiling instruction: " << e.what() << "\n";
+            return false;
+        }
+        program.code.push_back(op);
+    }
+    return true;
+}
+
+bool executeBytecodeOp(int processId, Session& session, const BytecodeOp& op, std::ostream& out) {
+    const Program& program = *session.program;
+    const ProcessVariables& vars = session.variables;
+
+    switch (op.op) {
+        case OpCode::DECLARE: {
+            int value = clampVariable(op.lhs.value);
+            if (!storeSlot(processId, session, op.slot, value)) return false;
+            out << "Process " << processId << " declared " << program.symbols[op.slot]
+                << " = " << value << "\n";
+            return true;
+        }
+
+        case OpCode::READ: {
+            if (op.address < 0 || op.address + static_cast<int>(sizeof(int)) > session.memorySize) {
+                std::cerr << "Error: Address " << program.strings[op.text] << " out of bounds\n";
+                return false;
+            }
+            if (op.address < SYMBOL_TABLE_SIZE) {
+                std::cerr << "Error: Address " << program.strings[op.text] << " is in the symbol_table segment\n";
+                return false;
+            }
+            int value;
+            if (!readMemory(processId, op.address, value)) {
+                std::cerr << "Error: Failed to read memory at address " << program.strings[op.text] << "\n";
+                return false;
+            }
+            if (!storeSlot(processId, session, op.slot, value)) return false;
+            out << "Process " << processId << " read " << program.symbols[op.slot] << " = " << value
+                << " from " << program.strings[op.text] << "\n";
+            return true;
+        }
+
+        case OpCode::WRITE: {
+            if (op.address < 0 || op.address + static_cast<int>(sizeof(int)) > session.memorySize) {
+                std::cerr << "Error: Address " << program.strings[op.text] << " out of bounds\n";
+                return false;
+            }
+            if (op.address < SYMBOL_TABLE_SIZE) {
+                std::cerr << "Error: Address " << program.strings[op.text] << " is in the symbol_table segment\n";
+                return false;
+            }
+            if (!vars.isDeclared(op.slot)) {
+                std::cerr << "Error: Variable '" << program.symbols[op.slot] << "' not declared\n";
+                return false;
+            }
+            int value;
+            if (!loadSlot(processId, op.slot, value)) return false;
+            if (!writeMemory(processId, op.address, value)) {
+                std::cerr << "Error: Failed to write memory at address " << program.strings[op.text] << "\n";
+                return false;
+            }
+            out << "Process " << processId << " wrote " << program.symbols[op.slot] << " (" << value
+                << ") to " << program.strings[op.text] << "\n";
+            return true;
+        }
+
+        case OpCode::ADD:
+        case OpCode::SUB:
+        case OpCode::MUL:
+        case OpCode::DIV: {
+            int op1, op2;
+            if (!operandValue(processId, session, program, op.lhs, op1) ||
+                !operandValue(processId, session, program, op.rhs, op2)) {
+                return false;
+            }
+
+            // Wide enough that no pair of int operands can overflow
+            long long exact;
+            char opChar;
+            switch (op.op) {
+                case OpCode::ADD: exact = static_cast<long long>(op1) + op2; opChar = '+'; break;
+                case OpCode::SUB: exact = static_cast<long long>(op1) - op2; opChar = '-'; break;
+                case OpCode::MUL: exact = static_cast<long long>(op1) * op2; opChar = '*'; break;
+                default:
+                    if (op2 == 0) {
+                        std::cerr << "Error: Division by zero\n";
+                        return false;
+                    }
+                    exact = static_cast<long long>(op1) / op2;
+                    opChar = '/';
+                    break;
+            }
+            int result = clampVariable(exact);
+
+            if (!storeSlot(processId, session, op.slot, result)) return false;
+            out << "Process " << processId << " computed " << program.symbols[op.slot] << " = "
+                << op1 << " " << opChar << " " << op2 << " = " << result << "\n";
+            return true;
+        }
+
+        case OpCode::PRINT: {
+            int value = 0;
+            bool showValue = op.slot >= 0 && vars.isDeclared(op.slot);
+            if (showValue && !loadSlot(processId, op.slot, value)) return false;
+
+            out << "Process " << processId << " prints: ";
+            if (op.text >= 0) out << program.strings[op.text];
+            if (showValue) out << value;
+            else if (op.slot >= 0) out << program.strings[op.fallback];
+            out << "\n";
+            return true;
+        }
+    }
+    return false;
+}
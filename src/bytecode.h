@@ -0,0 +1,51 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include "structures.h"
+#include <string>
+#include <vector>
+#include <ostream>
+
+enum class OpCode : unsigned char {
+    DECLARE,
+    ADD, SUB, MUL, DIV,
+    WRITE, READ,
+    PRINT
+};
+
+// Source operand resolved at compile time: a variable slot or a literal.
+struct OperandRef {
+    bool isSlot = false;
+    int value = 0;
+};
+
+// One lowered instruction. Variables are slot indices, literals and
+// addresses are already decoded and PRINT text lives in the string pool.
+struct BytecodeOp {
+    OpCode op = OpCode::DECLARE;
+    int slot = -1;       // destination, WRITE source or PRINT variable
+    OperandRef lhs;      // DECLARE value, arithmetic operands
+    OperandRef rhs;
+    int address = 0;     // READ/WRITE target
+    int text = -1;       // PRINT prefix in the string pool
+    int fallback = -1;   // PRINT text used while the variable is undeclared
+};
+
+struct Program {
+    std::vector<BytecodeOp> code;
+    std::vector<std::string> symbols;      // slot -> variable name
+    std::vector<std::string> strings;
+};
+
+inline int symbolAddress(int slot) { return slot * SYMBOL_SLOT_SIZE; }
+
+// Variables are uint16; DECLARE and arithmetic saturate at the ends of the range.
+const int VARIABLE_MAX = 65535;
+inline int clampVariable(long long value) {
+    return static_cast<int>(value < 0 ? 0 : value > VARIABLE_MAX ? VARIABLE_MAX : value);
+}
+
+bool compileProgram(const std::vector<Instruction>& instructions, int memorySize, Program& program);
+bool executeBytecodeOp(int processId, Session& session, const BytecodeOp& op, std::ostream& out);
+
+#endif // BYTECODE_H
@@ -0,0 +1,122 @@
+#include "compressed_swap.h"
+#include <algorithm>
+#include <cstring>
+
+// Byte-oriented run-length code. A header byte with the top bit set is a
+// run of (low bits + 1) copies of the byte after it; otherwise it is
+// followed by (header + 1) literal bytes. Runs shorter than three bytes
+// are cheaper as literals. Swapped pages are mostly zero-filled variable
+// slots, which this shrinks by well over an order of magnitude.
+static const int MAX_TOKEN = 128;
+
+static void compressPage(const char* in, int length, std::vector<char>& out) {
+    out.clear();
+    int literalStart = 0;
+    auto flushLiterals = [&](int end) {
+        while (literalStart < end) {
+            int count = std::min(MAX_TOKEN, end - literalStart);
+            out.push_back(static_cast<char>(count - 1));
+            out.insert(out.end(), in + literalStart, in + literalStart + count);
+            literalStart += count;
+        }
+    };
+
+    for (int i = 0; i < length;) {
+        int run = 1;
+        while (i + run < length && run < MAX_TOKEN && in[i + run] == in[i]) ++run;
+        if (run >= 3) {
+            flushLiterals(i);
+            out.push_back(static_cast<char>(0x80 | (run - 1)));
+            out.push_back(in[i]);
+            literalStart = i + run;
+        }
+        i += run;
+    }
+    flushLiterals(length);
+}
+
+static bool decompressPage(const std::vector<char>& in, char* out, int length) {
+    size_t pos = 0;
+    int written = 0;
+    while (pos < in.size()) {
+        unsigned char header = static_cast<unsigned char>(in[pos++]);
+        int count = (header & 0x7f) + 1;
+        if (written + count > length) return false;
+        if (header & 0x80) {
+            if (pos >= in.size()) return false;
+            std::fill(out + written, out + written + count, in[pos++]);
+        } else {
+            if (pos + count > in.size()) return false;
+            std::memcpy(out + written, &in[pos], count);
+            pos += count;
+        }
+        written += count;
+    }
+    return written == length;
+}
+
+void CompressedSwapCache::reset(int budget, int size) {
+    budgetBytes = std::max(0, budget);
+    pageSize = size;
+    lru.clear();
+    entries.clear();
+    stats = CompressedSwapStatistics();
+    stats.budgetBytes = budgetBytes;
+}
+
+void CompressedSwapCache::eraseEntry(std::unordered_map<int, Entry>::iterator it) {
+    stats.bytesHeld -= static_cast<int>(it->second.data.size());
+    stats.pagesHeld--;
+    lru.erase(it->second.position);
+    entries.erase(it);
+}
+
+bool CompressedSwapCache::store(int slot, const char* data, const std::function<void(int, const char*)>& spill) {
+    drop(slot);
+    if (!enabled()) return false;
+
+    // A page that saves less than a quarter of its size costs more to keep
+    // compressed than it saves
+    std::vector<char> compressed;
+    compressPage(data, pageSize, compressed);
+    int size = static_cast<int>(compressed.size());
+    if (size > pageSize * 3 / 4 || size > budgetBytes) {
+        stats.rejected++;
+        return false;
+    }
+
+    std::vector<char> page(pageSize);
+    while (stats.bytesHeld + size > budgetBytes) {
+        auto victim = entries.find(lru.back());
+        decompressPage(victim->second.data, page.data(), pageSize);
+        spill(victim->first, page.data());
+        stats.spills++;
+        eraseEntry(victim);
+    }
+
+    lru.push_front(slot);
+    Entry& entry = entries[slot];
+    entry.data.swap(compressed);
+    entry.position = lru.begin();
+    stats.bytesHeld += size;
+    stats.pagesHeld++;
+    stats.stores++;
+    stats.bytesIn += pageSize;
+    stats.bytesOut += size;
+    return true;
+}
+
+bool CompressedSwapCache::load(int slot, char* data) {
+    auto it = entries.find(slot);
+    if (it == entries.end()) return false;
+    if (!decompressPage(it->second.data, data, pageSize)) return false;
+    lru.splice(lru.begin(), lru, it->second.position);
+    stats.loads++;
+    stats.hits++;
+    return true;
+}
+
+void CompressedSwapCache::drop(int slot) {
+    auto it = entries.find(slot);
+    if (it != entries.end()) eraseEntry(it);
+}
@@ -0,0 +1,67 @@
+#ifndef COMPRESSED_SWAP_H
+#define COMPRESSED_SWAP_H
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+struct CompressedSwapStatistics {
+    int budgetBytes = 0;
+    int pagesHeld = 0;
+    int bytesHeld = 0;          // compressed bytes in the tier right now
+    long long stores = 0;       // pages compressed into the tier
+    long long rejected = 0;     // pages that compressed too poorly and went to the file
+    long long spills = 0;       // pages pushed out to the file to make room
+    long long loads = 0;        // swapped-out pages read back
+    long long hits = 0;         // of those, decompressed from the tier
+    long long bytesIn = 0;      // size of the pages stored in the tier
+    long long bytesOut = 0;     // their size compressed
+
+    double compressionRatio() const { return bytesOut > 0 ? static_cast<double>(bytesIn) / bytesOut : 0.0; }
+    double hitRate() const { return loads > 0 ? static_cast<double>(hits) / loads : 0.0; }
+};
+
+// zswap-style compressed copy of backing-store slots, kept in memory in
+// front of the file. A stored page stays in the tier until its slot is
+// overwritten or freed, or it is the least recently used page when room
+// is needed; it is then written to its slot in the file. compressed-swap-size
+// bounds the compressed bytes held. The backing store calls it under its
+// own lock.
+class CompressedSwapCache {
+private:
+    struct Entry {
+        std::vector<char> data;
+        std::list<int>::iterator position;
+    };
+
+    int budgetBytes;
+    int pageSize;
+    std::list<int> lru;                      // slots, most recently used first
+    std::unordered_map<int, Entry> entries;  // slot -> compressed page
+    CompressedSwapStatistics stats;
+
+    void eraseEntry(std::unordered_map<int, Entry>::iterator it);
+
+public:
+    CompressedSwapCache() : budgetBytes(0), pageSize(0) {}
+
+    void reset(int budgetBytes, int pageSize);
+    bool enabled() const { return budgetBytes > 0; }
+    bool holds(int slot) const { return entries.count(slot) != 0; }
+
+    // Replaces the slot's page with data. Pages pushed out to make room are
+    // handed to spill, uncompressed, before this returns. False if data is
+    // not kept and must be written to the file by the caller.
+    bool store(int slot, const char* data, const std::function<void(int, const char*)>& spill);
+    // Decompresses the slot's page into data. False if the tier does not
+    // hold it.
+    bool load(int slot, char* data);
+    void drop(int slot);
+    // Counts swapped-out pages read from the file instead of the tier.
+    void noteFileLoads(int pages) { stats.loads += pages; }
+
+    const CompressedSwapStatistics& statistics() const { return stats; }
+};
+
+#endif // COMPRESSED_SWAP_H
@@ -5,6 +5,15 @@
 
 Config config;
 
+static std::string readStringValue(std::ifstream& file) {
+    std::string value;
+    file >> value;
+    if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+    }
+    return value;
+}
+
 bool readConfig(const std::string& filename, Config& config) {
     std::ifstream file(filename.c_str());
     if (!file) {
@@ -14,21 +23,41 @@ bool readConfig(const std::string& filename, Config& config) {
     std::string key;
     while (file >> key) {
         if (key == "num-cpu") file >> config.num_cpu;
-        else if (key == "scheduler") file >> config.scheduler;
+        else if (key == "scheduler") config.scheduler = readStringValue(file);
         else if (key == "quantum-cycles") file >> config.quantum_cycles;
         else if (key == "batch-process-freq") file >> config.batch_process_freq;
         else if (key == "min-ins") file >> config.min_ins;
         else if (key == "max-ins") file >> config.max_ins;
-        else if (key == "delays-per-exec") file >> config.delays_per_exec;
+        else if (key == "delays-per-exec" || key == "delay-per-exec") file >> config.delays_per_exec;
         else if (key == "num-processes") file >> config.num_processes;
         else if (key == "prints-per-process") file >> config.prints_per_process;
         else if (key == "max-overall-mem") file >> config.max_memory_size;
         else if (key == "mem-per-frame") file >> config.mem_per_frame;
         else if (key == "mem-per-proc") file >> config.mem_per_proc;
+        else if (key == "min-mem-per-proc") file >> config.min_mem_per_proc;
+        else if (key == "max-mem-per-proc") file >> config.max_mem_per_proc;
         else if (key == "min-memory-size") file >> config.min_memory_size;
         else if (key == "max-memory-size") file >> config.max_memory_size;
         else if (key == "num-frames") file >> config.num_frames;
         else if (key == "backing-store-size") file >> config.backing_store_size;
+        else if (key == "compressed-swap-size") file >> config.compressed_swap_size;
+        else if (key == "clock-mode") config.clock_mode = readStringValue(file);
+        else if (key == "tick-ms") file >> config.tick_ms;
+        else if (key == "mlfq-levels") file >> config.mlfq_levels;
+        else if (key == "mlfq-aging-ticks") file >> config.mlfq_aging_ticks;
+        else if (key == "verbose-paging") file >> config.verbose_paging;
+        else if (key == "page-replacement") config.page_replacement = readStringValue(file);
+        else if (key == "page-replacement-compare") file >> config.page_replacement_compare;
+        else if (key == "tlb-entries") file >> config.tlb_entries;
+        else if (key == "writeback-watermark") file >> config.writeback_watermark;
+        else if (key == "writeback-batch") file >> config.writeback_batch;
+        else if (key == "readahead-max") file >> config.readahead_max;
+        else if (key == "dedup-scan-pages") file >> config.dedup_scan_pages;
+        else if (key == "dedup-sleep-ms") file >> config.dedup_sleep_ms;
+        else if (key == "pressure-window") file >> config.pressure_window;
+        else if (key == "pressure-high-faults") file >> config.pressure_high_faults;
+        else if (key == "pressure-low-faults") file >> config.pressure_low_faults;
+        else if (key == "memory-allocator") config.memory_allocator = readStringValue(file);
         else {
             std::string garbage;
             file >> garbage;
@@ -36,6 +65,10 @@ bool readConfig(const std::string& filename, Config& config) {
         }
     }
     config.num_frames = config.max_memory_size / config.mem_per_frame;
+    if (config.clock_mode != "virtual" && config.clock_mode != "realtime") {
+        std::cerr << "Warning: Unknown clock-mode '" << config.clock_mode << "'. Using realtime.\n";
+        config.clock_mode = "realtime";
+    }
     return true;
 }
 
@@ -48,4 +81,19 @@ void printConfig(const Config& config) {
     std::cout << "  min-ins: " << config.min_ins << "\n";
     std::cout << "  max-ins: " << config.max_ins << "\n";
     std::cout << "  delays-per-exec: " << config.delays_per_exec << "\n";
+    std::cout << "  clock-mode: " << config.clock_mode << "\n";
+    std::cout << "  tick-ms: " << config.tick_ms << "\n";
+    std::cout << "  page-replacement: " << config.page_replacement << "\n";
+    std::cout << "  tlb-entries: " << config.tlb_entries << "\n";
+    std::cout << "  writeback-watermark: " << config.writeback_watermark << "\n";
+    std::cout << "  writeback-batch: " << config.writeback_batch << "\n";
+    std::cout << "  readahead-max: " << config.readahead_max << "\n";
+    std::cout << "  dedup-scan-pages: " << config.dedup_scan_pages << "\n";
+    std::cout << "  dedup-sleep-ms: " << config.dedup_sleep_ms << "\n";
+    std::cout << "  pressure-window: " << config.pressure_window << "\n";
+    std::cout << "  pressure-high-faults: " << config.pressure_high_faults << "\n";
+    std::cout << "  pressure-low-faults: " << config.pressure_low_faults << "\n";
+    std::cout << "  backing-store-size: " << config.backing_store_size << "\n";
+    std::cout << "  compressed-swap-size: " << config.compressed_swap_size << "\n";
+    std::cout << "  memory-allocator: " << config.memory_allocator << "\n";
 }
@@ -0,0 +1,308 @@
+#include "contiguous_allocator.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+std::unique_ptr<ContiguousAllocator> contiguousAllocator;
+
+int MaxHoleTree::newNode() {
+    if (spare.empty()) {
+        nodes.emplace_back();
+        return static_cast<int>(nodes.size()) - 1;
+    }
+    int node = spare.back();
+    spare.pop_back();
+    nodes[node] = Node();
+    return node;
+}
+
+void MaxHoleTree::reset(int size) {
+    nodes.assign(1, Node());
+    spare.clear();
+    span = std::max(1, size);
+}
+
+// A child left with no block is returned to the pool, so every node but
+// the root covers at least one block.
+void MaxHoleTree::assign(int node, int low, int high, int at, int size) {
+    if (high - low == 1) {
+        nodes[node].best = size;
+        return;
+    }
+    int mid = low + (high - low) / 2;
+    int side = at < mid ? 0 : 1;
+    int child = nodes[node].child[side];
+    if (child == -1) {
+        if (size == 0) return;
+        child = newNode();
+        nodes[node].child[side] = child;
+    }
+    if (side == 0) {
+        assign(child, low, mid, at, size);
+    } else {
+        assign(child, mid, high, at, size);
+    }
+    if (nodes[child].best == 0) {
+        spare.push_back(child);
+        nodes[node].child[side] = -1;
+    }
+
+    int best = 0;
+    for (int c : nodes[node].child) {
+        if (c != -1) best = std::max(best, nodes[c].best);
+    }
+    nodes[node].best = best;
+}
+
+void MaxHoleTree::set(int start, int size) {
+    if (start < 0 || start >= span) return;
+    assign(0, 0, span, start, size);
+}
+
+int MaxHoleTree::firstFit(int bytes) const {
+    if (nodes.empty() || nodes[0].best < bytes) return -1;
+    int node = 0, low = 0, high = span;
+    while (high - low > 1) {
+        int mid = low + (high - low) / 2;
+        int left = nodes[node].child[0];
+        if (left != -1 && nodes[left].best >= bytes) {
+            node = left;
+            high = mid;
+        } else {
+            node = nodes[node].child[1];
+            low = mid;
+        }
+    }
+    return low;
+}
+
+void FreeBlockIndex::reset(int span) {
+    byAddress.clear();
+    bySize.clear();
+    byRange.reset(span);
+}
+
+void FreeBlockIndex::insert(int start, int size) {
+    byAddress[start] = size;
+    bySize.insert({size, start});
+    byRange.set(start, size);
+}
+
+void FreeBlockIndex::erase(int start) {
+    auto it = byAddress.find(start);
+    if (it == byAddress.end()) return;
+    bySize.erase({it->second, start});
+    byRange.set(start, 0);
+    byAddress.erase(it);
+}
+
+void FreeBlockIndex::insertCoalesced(int start, int size) {
+    auto next = byAddress.lower_bound(start);
+    if (next != byAddress.end() && start + size == next->first) {
+        size += next->second;
+        erase(next->first);
+    }
+    auto after = byAddress.lower_bound(start);
+    if (after != byAddress.begin()) {
+        auto prev = std::prev(after);
+        if (prev->first + prev->second == start) {
+            start = prev->first;
+            size += prev->second;
+            erase(start);
+        }
+    }
+    insert(start, size);
+}
+
+void FreeListAllocator::refreshFreeStats() {
+    stats.freeBytes = stats.totalBytes - stats.heldBytes;
+    stats.largestFreeBlock = freeBlocks.largest();
+    stats.freeBlocks = freeBlocks.count();
+}
+
+void FreeListAllocator::reset(int totalBytes) {
+    held.clear();
+    stats = ContiguousStatistics();
+    stats.totalBytes = std::max(0, totalBytes);
+    freeBlocks.reset(stats.totalBytes);
+    if (stats.totalBytes > 0) freeBlocks.insert(0, stats.totalBytes);
+    refreshFreeStats();
+}
+
+int FreeListAllocator::allocate(int processId, int bytes) {
+    if (bytes <= 0 || held.count(processId)) return -1;
+    int start = findBlock(bytes);
+    if (start == -1) {
+        stats.failedAllocations++;
+        return -1;
+    }
+
+    // Carve from the front of the hole; the tail stays free
+    int size = freeBlocks.blocks().at(start);
+    freeBlocks.erase(start);
+    if (size > bytes) freeBlocks.insert(start + bytes, size - bytes);
+    held[processId] = {start, bytes};
+
+    stats.heldBytes += bytes;
+    stats.requestedBytes += bytes;
+    stats.processes++;
+    refreshFreeStats();
+    return start;
+}
+
+void FreeListAllocator::release(int processId) {
+    auto it = held.find(processId);
+    if (it == held.end()) return;
+    int start = it->second.first;
+    int size = it->second.second;
+    held.erase(it);
+    freeBlocks.insertCoalesced(start, size);
+
+    stats.heldBytes -= size;
+    stats.requestedBytes -= size;
+    stats.processes--;
+    refreshFreeStats();
+}
+
+std::vector<MemoryBlock> FreeListAllocator::blocks() const {
+    std::vector<MemoryBlock> result;
+    result.reserve(held.size() + freeBlocks.blocks().size());
+    for (const auto& block : freeBlocks.blocks()) {
+        result.push_back({block.first, block.first + block.second - 1, -1});
+    }
+    for (const auto& entry : held) {
+        result.push_back({entry.second.first, entry.second.first + entry.second.second - 1, entry.first});
+    }
+    std::sort(result.begin(), result.end(),
+              [](const MemoryBlock& a, const MemoryBlock& b) { return a.start < b.start; });
+    return result;
+}
+
+int FirstFitAllocator::findBlock(int bytes) const {
+    return freeBlocks.firstFit(bytes);
+}
+
+int BestFitAllocator::findBlock(int bytes) const {
+    auto it = freeBlocks.sizes().lower_bound({bytes, 0});
+    return it == freeBlocks.sizes().end() ? -1 : it->second;
+}
+
+int BuddyAllocator::orderFor(int bytes) const {
+    int order = 0;
+    while (blockSize(order) < bytes) ++order;
+    return order;
+}
+
+void BuddyAllocator::refreshFreeStats() {
+    stats.freeBytes = 0;
+    stats.freeBlocks = 0;
+    stats.largestFreeBlock = 0;
+    for (size_t order = 0; order < freeByOrder.size(); ++order) {
+        int count = static_cast<int>(freeByOrder[order].size());
+        stats.freeBytes += count * blockSize(static_cast<int>(order));
+        stats.freeBlocks += count;
+        if (count > 0) stats.largestFreeBlock = blockSize(static_cast<int>(order));
+    }
+}
+
+void BuddyAllocator::reset(int totalBytes) {
+    held.clear();
+    requested.clear();
+    stats = ContiguousStatistics();
+    stats.totalBytes = std::max(0, totalBytes);
+
+    // Largest aligned power-of-two regions from address 0 up; a tail
+    // smaller than MIN_BLOCK is never handed out
+    largestOrder = -1;
+    while (stats.totalBytes >= blockSize(largestOrder + 1)) ++largestOrder;
+    freeByOrder.assign(std::max(0, largestOrder + 1), std::set<int>());
+    int start = 0;
+    for (int order = largestOrder; order >= 0; --order) {
+        if (stats.totalBytes - start >= blockSize(order)) {
+            freeByOrder[order].insert(start);
+            start += blockSize(order);
+        }
+    }
+    refreshFreeStats();
+}
+
+bool BuddyAllocator::canEverFit(int bytes) const {
+    return bytes > 0 && largestOrder >= 0 && orderFor(bytes) <= largestOrder;
+}
+
+int BuddyAllocator::allocate(int processId, int bytes) {
+    if (!canEverFit(bytes) || held.count(processId)) return -1;
+    int order = orderFor(bytes);
+
+    // Smallest free block at or above the wanted order, split down to it
+    int from = order;
+    while (from <= largestOrder && freeByOrder[from].empty()) ++from;
+    if (from > largestOrder) {
+        stats.failedAllocations++;
+        return -1;
+    }
+    int start = *freeByOrder[from].begin();
+    freeByOrder[from].erase(freeByOrder[from].begin());
+    while (from > order) {
+        --from;
+        freeByOrder[from].insert(start + blockSize(from));
+    }
+
+    held[processId] = {start, order};
+    requested[processId] = bytes;
+    stats.heldBytes += blockSize(order);
+    stats.requestedBytes += bytes;
+    stats.processes++;
+    refreshFreeStats();
+    return start;
+}
+
+void BuddyAllocator::release(int processId) {
+    auto it = held.find(processId);
+    if (it == held.end()) return;
+    int start = it->second.first;
+    int order = it->second.second;
+    held.erase(it);
+    stats.heldBytes -= blockSize(order);
+    stats.requestedBytes -= requested[processId];
+    stats.processes--;
+    requested.erase(processId);
+
+    // A buddy outside the initial regions is never on a free list, so
+    // merging cannot cross from one region into the next
+    while (order < largestOrder) {
+        int buddy = start ^ blockSize(order);
+        auto free = freeByOrder[order].find(buddy);
+        if (free == freeByOrder[order].end()) break;
+        freeByOrder[order].erase(free);
+        start = std::min(start, buddy);
+        ++order;
+    }
+    freeByOrder[order].insert(start);
+    refreshFreeStats();
+}
+
+std::vector<MemoryBlock> BuddyAllocator::blocks() const {
+    std::vector<MemoryBlock> result;
+    for (size_t order = 0; order < freeByOrder.size(); ++order) {
+        for (int start : freeByOrder[order]) {
+            result.push_back({start, start + blockSize(static_cast<int>(order)) - 1, -1});
+        }
+    }
+    for (const auto& entry : held) {
+        int start = entry.second.first;
+        result.push_back({start, start + blockSize(entry.second.second) - 1, entry.first});
+    }
+    std::sort(result.begin(), result.end(),
+              [](const MemoryBlock& a, const MemoryBlock& b) { return a.start < b.start; });
+    return result;
+}
+
+std::unique_ptr<ContiguousAllocator> createContiguousAllocator(const std::string& name) {
+    if (name == "first-fit") return std::unique_ptr<ContiguousAllocator>(new FirstFitAllocator());
+    if (name == "best-fit") return std::unique_ptr<ContiguousAllocator>(new BestFitAllocator());
+    if (name == "buddy") return std::unique_ptr<ContiguousAllocator>(new BuddyAllocator());
+
+    std::cerr << "Warning: Unknown memory-allocator '" << name << "'. Using first-fit.\n";
+    return std::unique_ptr<ContiguousAllocator>(new FirstFitAllocator());
+}
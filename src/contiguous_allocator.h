@@ -0,0 +1,173 @@
+#ifndef CONTIGUOUS_ALLOCATOR_H
+#define CONTIGUOUS_ALLOCATOR_H
+
+#include "structures.h"
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct ContiguousStatistics {
+    int totalBytes = 0;
+    int heldBytes = 0;        // bytes in blocks given to processes
+    int requestedBytes = 0;   // bytes those processes asked for
+    int freeBytes = 0;
+    int largestFreeBlock = 0;
+    int freeBlocks = 0;
+    int processes = 0;
+    long long failedAllocations = 0;   // allocate calls that found no block
+
+    int internalFragmentation() const { return heldBytes - requestedBytes; }
+    // Free memory that cannot serve a request as large as the biggest hole
+    int externalFragmentation() const { return freeBytes - largestFreeBlock; }
+    double utilization() const { return totalBytes > 0 ? static_cast<double>(heldBytes) / totalBytes : 0.0; }
+};
+
+// Places each admitted process in one contiguous range of max-overall-mem
+// and takes it back when the process finishes. Free space is kept in
+// ordered indexes so placing and freeing never walk every block. Callers
+// hold memoryMutex.
+class ContiguousAllocator {
+protected:
+    ContiguousStatistics stats;
+
+public:
+    virtual ~ContiguousAllocator() = default;
+    virtual std::string name() const = 0;
+
+    virtual void reset(int totalBytes) = 0;
+    // Start address of the block given to the process, or -1 if no free
+    // block is large enough right now.
+    virtual int allocate(int processId, int bytes) = 0;
+    virtual void release(int processId) = 0;
+    // False if the request could not be placed even in empty memory.
+    virtual bool canEverFit(int bytes) const = 0;
+    // Every block, free (pid -1) or held, in address order.
+    virtual std::vector<MemoryBlock> blocks() const = 0;
+
+    const ContiguousStatistics& statistics() const { return stats; }
+};
+
+// Largest free block per address range: a sparse segment tree over
+// [0, span) with a leaf at each block start, holding that block's size.
+// Only ranges that contain a block have nodes, and emptied ones go back to
+// the pool, so it stays proportional to the number of blocks.
+class MaxHoleTree {
+private:
+    struct Node {
+        int best = 0;
+        int child[2] = {-1, -1};
+    };
+
+    std::vector<Node> nodes;   // nodes[0] is the root
+    std::vector<int> spare;
+    int span = 0;
+
+    int newNode();
+    void assign(int node, int low, int high, int at, int size);
+
+public:
+    void reset(int span);
+    // Size of the block starting at start; 0 removes it.
+    void set(int start, int size);
+    // Lowest start of a block of at least bytes, or -1, in O(log span).
+    int firstFit(int bytes) const;
+};
+
+// Free blocks indexed by address, to find and merge neighbours, by
+// (size, address), to find the smallest block large enough, and by
+// largest block per address range, to find the lowest one large enough.
+// Each lookup is O(log n).
+class FreeBlockIndex {
+private:
+    std::map<int, int> byAddress;             // start -> size
+    std::set<std::pair<int, int>> bySize;     // (size, start)
+    MaxHoleTree byRange;
+
+public:
+    void reset(int span);
+    void insert(int start, int size);
+    void erase(int start);
+    // Inserts the block and merges it with free neighbours on either side.
+    void insertCoalesced(int start, int size);
+    const std::map<int, int>& blocks() const { return byAddress; }
+    const std::set<std::pair<int, int>>& sizes() const { return bySize; }
+    int largest() const { return bySize.empty() ? 0 : bySize.rbegin()->first; }
+    int firstFit(int bytes) const { return byRange.firstFit(bytes); }
+    int count() const { return static_cast<int>(byAddress.size()); }
+};
+
+// Variable-size blocks carved from the free index and coalesced on free.
+// Subclasses only decide which free block a request is carved from.
+class FreeListAllocator : public ContiguousAllocator {
+protected:
+    FreeBlockIndex freeBlocks;
+    std::unordered_map<int, std::pair<int, int>> held;   // pid -> (start, size)
+
+    // Start of the free block to carve bytes from, or -1.
+    virtual int findBlock(int bytes) const = 0;
+    void refreshFreeStats();
+
+public:
+    void reset(int totalBytes) override;
+    int allocate(int processId, int bytes) override;
+    void release(int processId) override;
+    bool canEverFit(int bytes) const override { return bytes > 0 && bytes <= stats.totalBytes; }
+    std::vector<MemoryBlock> blocks() const override;
+};
+
+// Lowest-addressed hole that fits, found by descending the max-hole tree.
+class FirstFitAllocator : public FreeListAllocator {
+protected:
+    int findBlock(int bytes) const override;
+
+public:
+    std::string name() const override { return "first-fit"; }
+};
+
+// Smallest hole that fits, lowest address on ties.
+class BestFitAllocator : public FreeListAllocator {
+protected:
+    int findBlock(int bytes) const override;
+
+public:
+    std::string name() const override { return "best-fit"; }
+};
+
+// Binary buddy system. Requests are rounded up to a power of two no smaller
+// than MIN_BLOCK; a freed block merges with its buddy while the buddy is
+// free too. Memory that is not a power of two is split into the largest
+// aligned power-of-two regions, each its own buddy tree.
+class BuddyAllocator : public ContiguousAllocator {
+private:
+    static const int MIN_BLOCK = 64;
+
+    std::vector<std::set<int>> freeByOrder;   // order -> free block starts
+    std::unordered_map<int, std::pair<int, int>> held;   // pid -> (start, order)
+    std::unordered_map<int, int> requested;              // pid -> bytes asked for
+    int largestOrder;
+
+    static int blockSize(int order) { return MIN_BLOCK << order; }
+    int orderFor(int bytes) const;
+    void refreshFreeStats();
+
+public:
+    BuddyAllocator() : largestOrder(-1) {}
+    std::string name() const override { return "buddy"; }
+    void reset(int totalBytes) override;
+    int allocate(int processId, int bytes) override;
+    void release(int processId) override;
+    bool canEverFit(int bytes) const override;
+    std::vector<MemoryBlock> blocks() const override;
+};
+
+std::unique_ptr<ContiguousAllocator> createContiguousAllocator(const std::string& name);
+
+// Null while memory-allocator is "none": processes are admitted without a
+// contiguous block and demand paging alone bounds their memory.
+extern std::unique_ptr<ContiguousAllocator> contiguousAllocator;
+
+#endif // CONTIGUOUS_ALLOCATOR_H
@@ -13,18 +13,16 @@
 extern std::map<int, Session> sessions;
 extern std::map<int, std::string> processNames;
 extern std::atomic<bool> stopScheduler;
+extern std::atomic<bool> generatorRunning;
+extern std::atomic<bool> admissionOpen;
+extern std::atomic<int> nextPid;
 
-extern std::vector<std::queue<int>> coreQueues;
-extern std::vector<std::mutex> coreMutexes;
-extern std::vector<std::condition_variable> coreCVs;
-
-extern std::vector<MemoryBlock> memoryBlocks;
 extern std::mutex memoryMutex;
 extern std::mutex sessionMutex;
 extern int snapshotCounter;
 extern bool enableSnapshots;
 
-extern int total_cpu_active_ticks;
-extern int total_cpu_idle_ticks;
+extern std::atomic<long long> total_cpu_active_ticks;
+extern std::atomic<long long> total_cpu_idle_ticks;
 
 #endif // GLOBALS_H
@@ -1,7 +1,5 @@
 #include "instruction.h"
 #include "utils.h"
-#include "globals.h"
-#include "memory_manager.h"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -208,165 +206,6 @@ bool parseInstructions(const std::string& instructionString, std::vector<Instruc
     return true;
 }
 
-bool executeInstructionWithPaging(int processId, const Instruction& instruction) {
-    auto& variables = sessions[processId].variables;
-    
-    try {
-        switch (instruction.type) {
-            case InstructionType::DECLARE: {
-                std::string varName = instruction.operands[0];
-                int value = std::stoi(instruction.operands[1]);
-                variables.variables[varName] = value;
-                
-                int address = std::hash<std::string>{}(varName) % sessions[processId].memorySize;
-                writeMemory(processId, address, value);
-                
-                std::cout << "Process " << processId << " declared " << varName << " = " << value << "\n";
-                break;
-            }
-            
-            case InstructionType::READ: {
-                std::string varName = instruction.operands[0];
-                int address = hexToInt(instruction.operands[1]);
-                
-                if (address >= sessions[processId].memorySize) {
-                    std::cerr << "Error: Address " << instruction.operands[1] << " out of bounds\n";
-                    return false;
-                }
-                
-                int value;
-                if (readMemory(processId, address, value)) {
-                    variables.variables[varName] = value;
-                    std::cout << "Process " << processId << " read " << varName << " = " << value 
-                              << " from " << instruction.operands[1] << "\n";
-                } else {
-                    std::cerr << "Error: Failed to read memory at address " << instruction.operands[1] << "\n";
-                    return false;
-                }
-                break;
-            }
-            
-            case InstructionType::WRITE: {
-                int address = hexToInt(instruction.operands[0]);
-                std::string varName = instruction.operands[1];
-                
-                if (address >= sessions[processId].memorySize) {
-                    std::cerr << "Error: Address " << instruction.operands[0] << " out of bounds\n";
-                    return false;
-                }
-                
-                if (variables.variables.find(varName) == variables.variables.end()) {
-                    std::cerr << "Error: Variable '" << varName << "' not declared\n";
-                    return false;
-                }
-                
-                int value = variables.variables[varName];
-                if (writeMemory(processId, address, value)) {
-                    std::cout << "Process " << processId << " wrote " << varName << " (" << value 
-                              << ") to " << instruction.operands[0] << "\n";
-                } else {
-                    std::cerr << "Error: Failed to write memory at address " << instruction.operands[0] << "\n";
-                    return false;
-                }
-                break;
-            }
-            
-            case InstructionType::ADD:
-            case InstructionType::SUB:
-            case InstructionType::MUL:
-            case InstructionType::DIV: {
-                std::string resultVar = instruction.operands[0];
-                
-                int op1, op2;
-                
-                if (variables.variables.find(instruction.operands[1]) != variables.variables.end()) {
-                    op1 = variables.variables[instruction.operands[1]];
-                } else {
-                    try {
-                        op1 = std::stoi(instruction.operands[1]);
-                    } catch (const std::exception&) {
-                        std::cerr << "Error: Invalid operand '" << instruction.operands[1] << "'\n";
-                        return false;
-                    }
-                }
-                
-                if (variables.variables.find(instruction.operands[2]) != variables.variables.end()) {
-                    op2 = variables.variables[instruction.operands[2]];
-                } else {
-                    try {
-                        op2 = std::stoi(instruction.operands[2]);
-                    } catch (const std::exception&) {
-                        std::cerr << "Error: Invalid operand '" << instruction.operands[2] << "'\n";
-                        return false;
-                    }
-                }
-                
-                int result;
-                std::string op_str;
-                switch (instruction.type) {
-                    case InstructionType::ADD: result = op1 + op2; op_str = "+"; break;
-                    case InstructionType::SUB: result = op1 - op2; op_str = "-"; break;
-                    case InstructionType::MUL: result = op1 * op2; op_str = "*"; break;
-                    case InstructionType::DIV: 
-                        if (op2 == 0) {
-                            std::cerr << "Error: Division by zero\n";
-                            return false;
-                        }
-                        result = op1 / op2; 
-                        op_str = "/";
-                        break;
-                    default: return false;
-                }
-                
-                variables.variables[resultVar] = result;
-                
-                int address = std::hash<std::string>{}(resultVar) % sessions[processId].memorySize;
-                writeMemory(processId, address, result);
-                
-                std::cout << "Process " << processId << " computed " << resultVar << " = " 
-                          << op1 << " " << op_str << " " << op2 << " = " << result << "\n";
-                break;
-            }
-            
-            case InstructionType::PRINT: {
-                std::string content = instruction.operands[0];
-                
-                if (variables.variables.find(content) != variables.variables.end()) {
-                    std::cout << "Process " << processId << " prints: " << variables.variables[content] << "\n";
-                } else {
-                    std::string output = content;
-                    
-                    size_t plusPos = content.find(" + ");
-                    if (plusPos != std::string::npos) {
-                        std::string leftPart = trim(content.substr(0, plusPos));
-                        std::string rightPart = trim(content.substr(plusPos + 3));
-                        
-                        if (leftPart.front() == '"' && leftPart.back() == '"') {
-                            leftPart = leftPart.substr(1, leftPart.length() - 2);
-                        }
-                        
-                        if (variables.variables.find(rightPart) != variables.variables.end()) {
-                            output = leftPart + std::to_string(variables.variables[rightPart]);
-                        } else {
-                            output = leftPart + rightPart;
-                        }
-                    } else if (content.front() == '"' && content.back() == '"') {
-                        output = content.substr(1, content.length() - 2);
-                    }
-                    
-                    std::cout << "Process " << processId << " prints: " << output << "\n";
-                }
-                break;
-            }
-        }
-        
-        return true;
-    } catch (const std::exception& e) {
-        std::cerr << "Error executing instruction: " << e.what() << "\n";
-        return false;
-    }
-}
-
 void printInstructions(const std::vector<Instruction>& instructions) {
     std::cout << "Parsed Instructions (" << instructions.size() << " total):\n";
     for (size_t i = 0; i < instructions.size(); ++i) {
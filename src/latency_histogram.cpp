@@ -0,0 +1,65 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram() : samples(0), totalNanos(0), maxNanos(0) {
+    for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+}
+
+// Values below SUB_BUCKETS get a bucket each. Above that, the leading bit
+// picks the power of two and the next SUB_BUCKET_BITS bits the step in it.
+int LatencyHistogram::bucketFor(uint64_t nanos) {
+    if (nanos < static_cast<uint64_t>(SUB_BUCKETS)) return static_cast<int>(nanos);
+    int exponent = 63;
+    while (!((nanos >> exponent) & 1)) --exponent;
+    int shift = exponent - SUB_BUCKET_BITS;
+    int step = static_cast<int>((nanos >> shift) & (SUB_BUCKETS - 1));
+    return (shift + 1) * SUB_BUCKETS + step;
+}
+
+uint64_t LatencyHistogram::bucketLimit(int bucket) {
+    if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t step = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+    uint64_t low = (static_cast<uint64_t>(SUB_BUCKETS) + step) << shift;
+    return low + ((static_cast<uint64_t>(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+    counts[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+    samples.fetch_add(1, std::memory_order_relaxed);
+    totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    uint64_t seen = maxNanos.load(std::memory_order_relaxed);
+    while (nanos > seen && !maxNanos.compare_exchange_weak(seen, nanos, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts) count.store(0, std::memory_order_relaxed);
+    samples.store(0, std::memory_order_relaxed);
+    totalNanos.store(0, std::memory_order_relaxed);
+    maxNanos.store(0, std::memory_order_relaxed);
+}
+
+void LatencySnapshot::add(const LatencyHistogram& histogram) {
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        counts[i] += histogram.counts[i].load(std::memory_order_relaxed);
+    }
+    samples += histogram.samples.load(std::memory_order_relaxed);
+    totalNanos += histogram.totalNanos.load(std::memory_order_relaxed);
+    maxNanos = std::max(maxNanos, histogram.maxNanos.load(std::memory_order_relaxed));
+}
+
+// Walks the buckets rather than trusting samples, which a concurrent
+// record may have bumped before or after its bucket.
+uint64_t LatencySnapshot::percentile(double q) const {
+    long long bucketed = 0;
+    for (long long count : counts) bucketed += count;
+    if (bucketed == 0) return 0;
+    long long rank = std::max(1LL, static_cast<long long>(std::ceil(q * bucketed)));
+    long long seen = 0;
+    for (int i = 0; i < LatencyHistogram::BUCKETS; ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::min(LatencyHistogram::bucketLimit(i), maxNanos);
+    }
+    return maxNanos;
+}
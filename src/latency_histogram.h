@@ -0,0 +1,74 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Durations in nanoseconds, counted in log-scale buckets: every power of
+// two is split into SUB_BUCKETS equal steps, so a percentile read back is
+// within 1/SUB_BUCKETS of the true value at any scale. Recording is a
+// few relaxed atomic adds, so one writer per histogram never waits and
+// readers can take a snapshot while it records.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static const int BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t nanos);
+    void recordSince(std::chrono::steady_clock::time_point start) {
+        record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count()));
+    }
+    // Samples recorded while this runs may be kept or dropped.
+    void reset();
+
+    static int bucketFor(uint64_t nanos);
+    // Largest duration that falls into the bucket.
+    static uint64_t bucketLimit(int bucket);
+
+private:
+    friend struct LatencySnapshot;
+
+    std::atomic<long long> counts[BUCKETS];
+    std::atomic<long long> samples;
+    std::atomic<uint64_t> totalNanos;
+    std::atomic<uint64_t> maxNanos;
+};
+
+// Plain copy of one or more histograms, summed bucket by bucket.
+struct LatencySnapshot {
+    std::vector<long long> counts;
+    long long samples = 0;
+    uint64_t totalNanos = 0;
+    uint64_t maxNanos = 0;
+
+    LatencySnapshot() : counts(LatencyHistogram::BUCKETS, 0) {}
+    void add(const LatencyHistogram& histogram);
+    // Upper edge of the bucket holding the q-th quantile, capped at the max.
+    uint64_t percentile(double q) const;
+    double meanNanos() const { return samples > 0 ? static_cast<double>(totalNanos) / samples : 0.0; }
+};
+
+// Records the time from construction to destruction, so every return
+// path of a scope is timed.
+class LatencyTimer {
+private:
+    LatencyHistogram& histogram;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    explicit LatencyTimer(LatencyHistogram& target)
+        : histogram(target), start(std::chrono::steady_clock::now()) {}
+    ~LatencyTimer() { histogram.recordSince(start); }
+    LatencyTimer(const LatencyTimer&) = delete;
+    LatencyTimer& operator=(const LatencyTimer&) = delete;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -2,228 +2,1196 @@
 #include "structures.h"
 #include "config.h"
 #include "globals.h"
+#include "sim_clock.h"
+#include "page_trace.h"
 #include <iostream>
 #include <iomanip>
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <cstring>
 
 DemandPagingAllocator demandPagingAllocator;
 
-void writePageToBackingStore(int processId, int pageNumber, const std::vector<int>& pageData) {
-    std::ofstream ofs("csopesy-backing-store.txt", std::ios::app);
-    if (!ofs) return;
-    ofs << "PID " << processId << " PAGE " << pageNumber << " DATA";
-    for (int val : pageData) ofs << " " << val;
-    ofs << "\n";
-}
-
-std::vector<int> readPageFromBackingStore(int processId, int pageNumber) {
-    std::ifstream ifs("csopesy-backing-store.txt");
-    std::vector<int> pageData(config.mem_per_frame / sizeof(int), 0);
-    if (!ifs) return pageData;
-    std::string line;
-    while (std::getline(ifs, line)) {
-        std::istringstream iss(line);
-        std::string pidLabel, pageLabel, dataLabel;
-        int pid, page;
-        iss >> pidLabel >> pid >> pageLabel >> page >> dataLabel;
-        if (pid == processId && page == pageNumber) {
-            for (int& val : pageData) {
-                if (!(iss >> val)) break;
-            }
-            break;
+// Core the calling thread simulates; -1 for threads that are not CPU workers
+static thread_local int currentCore = -1;
+
+// FNV-1a over a page. Equal hashes only nominate frames for merging; the
+// merge itself compares the bytes.
+static unsigned long long hashPage(const char* data, int length) {
+    unsigned long long hash = 14695981039346656037ull;
+    for (int i = 0; i < length; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+DemandPagingAllocator::DemandPagingAllocator()
+    : frameLocks(FRAME_LOCK_STRIPES), residentHits(0), writebackStop(false), dirtyFrames(0),
+      zeroFrame(-1), dedupStop(false), dedupCursor(0), majorFaults(0), prefetchHits(0) {}
+
+// Sizes physical memory from config.txt and drops every resident and
+// swapped page. Called after the config is read and whenever the process
+// table is cleared, so PIDs that are handed out again start empty.
+void DemandPagingAllocator::initialize() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    // Let a batch that is being written land before the store is reset
+    std::lock_guard<std::mutex> batchLock(writebackMutex);
+    writebackInFlight.clear();
+    writebackStats = WritebackStatistics();
+    readaheadStates.clear();
+    readaheadStats = ReadaheadStatistics();
+    sharedMappings.clear();
+    cowStats = CopyOnWriteStatistics();
+    dedupCursor = 0;
+    dedupIndex.clear();
+    dedupStats = DedupStatistics();
+    majorFaults = 0;
+    faultsByProcess.clear();
+    prefetchHits = 0;
+    dirtyFrames = 0;
+    
+    // The zero page is allocated on top of max-overall-mem, not out of it
+    zeroFrame = config.page_replacement_compare ? -1 : config.num_frames;
+    int allocatedFrames = config.num_frames + (zeroFrame != -1 ? 1 : 0);
+    physicalFrames = std::vector<PhysicalFrame>(allocatedFrames);
+    physicalMemory.assign(static_cast<size_t>(allocatedFrames) * config.mem_per_frame, 0);
+    freeFrames = std::queue<int>();
+    residentSets.reset(config.num_frames);
+    for (int i = 0; i < allocatedFrames; ++i) physicalFrames[i].frameNumber = i;
+    for (int i = 0; i < config.num_frames; ++i) freeFrames.push(i);
+    stats = PagingStatistics();
+    residentHits = 0;
+    {
+        std::lock_guard<std::shared_timed_mutex> layoutsLock(layoutsMutex);
+        layouts.clear();
+    }
+
+    // One log per core plus one for threads that are not core workers
+    accessLogs.clear();
+    for (int i = 0; i <= config.num_cpu; ++i) accessLogs.emplace_back(new AccessLog());
+    faultLatencies.clear();
+    for (int i = 0; i <= config.num_cpu; ++i) faultLatencies.emplace_back(new FaultLatencies());
+
+    replacementPolicy = createReplacementPolicy(config.page_replacement);
+    config.page_replacement = replacementPolicy->name();
+    replacementPolicy->reset(config.num_frames);
+
+    // Shadow pagers see the same page accesses under every other policy
+    shadowPagers.clear();
+    if (config.page_replacement_compare) {
+        for (const auto& name : replacementPolicyNames()) {
+            if (name == config.page_replacement) continue;
+            shadowPagers.emplace_back(new PageCacheSimulator(createReplacementPolicy(name), config.num_frames));
         }
     }
-    return pageData;
+
+    // TLB hits bypass the pager, so the TLB stays off while shadows need every access
+    coreTlbs.clear();
+    int tlbEntries = config.page_replacement_compare ? 0 : config.tlb_entries;
+    if (tlbEntries > 0) {
+        for (int i = 0; i < config.num_cpu; ++i) {
+            coreTlbs.emplace_back(new CoreTlb());
+            coreTlbs.back()->entries.assign(tlbEntries, TlbEntry());
+        }
+    }
+    backingStore.reset();
+
+    // Asking for every frame to be clean would have the daemon rewrite the
+    // same hot page forever, so at least one frame may stay dirty
+    config.writeback_watermark = std::max(0, std::min(config.writeback_watermark, config.num_frames - 1));
+
+    // Like the TLB, the daemon is off in compare mode: cleaning pages early
+    // would make the live write-back count incomparable with the shadows'
+    if (!writebackThread.joinable() && config.writeback_watermark > 0 && !config.page_replacement_compare) {
+        writebackThread = std::thread(&DemandPagingAllocator::writebackDaemon, this);
+    }
+    if (!dedupThread.joinable() && config.dedup_scan_pages > 0 && zeroFrame != -1) {
+        dedupThread = std::thread(&DemandPagingAllocator::dedupScanner, this);
+    }
 }
 
-DemandPagingAllocator::DemandPagingAllocator() : pageFaultCount(0), pageReplacementCount(0) {
-    physicalFrames.resize(config.num_frames);
-    for (int i = 0; i < config.num_frames; ++i) {
-        physicalFrames[i] = PhysicalFrame(i);
-        freeFrames.push(i);
+void DemandPagingAllocator::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(framesMutex);
+        writebackStop = true;
+        dedupStop = true;
     }
+    writebackCV.notify_all();
+    dedupCV.notify_all();
+    if (writebackThread.joinable()) writebackThread.join();
+    if (dedupThread.joinable()) dedupThread.join();
 }
 
-int DemandPagingAllocator::findLRUFrame() {
-    int lruFrame = -1;
-    Clock::time_point oldestTime = Clock::now();
-    
-    for (int i = 0; i < config.num_frames; ++i) {
-        if (physicalFrames[i].isOccupied && physicalFrames[i].lastAccessed < oldestTime) {
-            oldestTime = physicalFrames[i].lastAccessed;
-            lruFrame = i;
+void DemandPagingAllocator::registerProcess(int processId, ProcessMemoryLayout* layout) {
+    std::lock_guard<std::shared_timed_mutex> layoutsLock(layoutsMutex);
+    layouts[processId] = layout;
+}
+
+ProcessMemoryLayout* DemandPagingAllocator::layoutFor(int processId) {
+    std::shared_lock<std::shared_timed_mutex> layoutsLock(layoutsMutex);
+    auto it = layouts.find(processId);
+    return it != layouts.end() ? it->second : nullptr;
+}
+
+// Callers hold framesMutex or the frame's stripe lock. Without framesMutex
+// the daemon's condition may be checked too early to see the wake-up; its
+// periodic wake covers that.
+void DemandPagingAllocator::setFrameDirty(int frameNumber, bool dirty) {
+    PhysicalFrame& frame = physicalFrames[frameNumber];
+    if (frame.isDirty.exchange(dirty) == dirty) return;
+    dirtyFrames += dirty ? 1 : -1;
+    if (dirty && needsWriteback()) writebackCV.notify_one();
+}
+
+// Records a reference made outside framesMutex. Only the first reference
+// since the policy last heard about the frame is logged.
+void DemandPagingAllocator::markReferenced(int frameNumber) {
+    if (physicalFrames[frameNumber].isReferenced.exchange(true)) return;
+    int core = currentCore >= 0 && currentCore < config.num_cpu ? currentCore : config.num_cpu;
+    AccessLog& log = *accessLogs[core];
+    std::lock_guard<std::mutex> logLock(log.logMutex);
+    log.frames.push_back(frameNumber);
+}
+
+LatencyHistogram& DemandPagingAllocator::latencyFor(FaultStage stage) {
+    int core = currentCore >= 0 && currentCore < config.num_cpu ? currentCore : config.num_cpu;
+    return faultLatencies[core]->stages[static_cast<int>(stage)];
+}
+
+LatencySnapshot DemandPagingAllocator::getFaultLatency(FaultStage stage, int coreId) const {
+    LatencySnapshot snapshot;
+    for (size_t i = 0; i < faultLatencies.size(); ++i) {
+        if (coreId == -1 || static_cast<int>(i) == coreId) snapshot.add(faultLatencies[i]->stages[static_cast<int>(stage)]);
+    }
+    return snapshot;
+}
+
+void DemandPagingAllocator::resetFaultLatency() {
+    for (auto& latencies : faultLatencies) {
+        for (auto& histogram : latencies->stages) histogram.reset();
+    }
+}
+
+// Hands logged references to the policy before it picks a victim.
+void DemandPagingAllocator::drainAccessLogsLocked() {
+    std::vector<int> frames;
+    for (auto& log : accessLogs) {
+        {
+            std::lock_guard<std::mutex> logLock(log->logMutex);
+            frames.swap(log->frames);
         }
+        for (int frameNumber : frames) {
+            PhysicalFrame& frame = physicalFrames[frameNumber];
+            if (frame.isReferenced.exchange(false) && frame.isOccupied) replacementPolicy->onAccess(frameNumber);
+        }
+        frames.clear();
     }
-    return lruFrame;
 }
 
-void DemandPagingAllocator::swapPageOut(int frameNumber) {
+// Bookkeeping shared by every path that touches a resident frame.
+void DemandPagingAllocator::noteFrameAccess(int frameNumber) {
     PhysicalFrame& frame = physicalFrames[frameNumber];
+    frame.lastAccessTick.store(simClock.now(), std::memory_order_relaxed);
+    if (frame.isPrefetched.exchange(false)) prefetchHits++;
+}
+
+// Free and clean frames can be handed to a fault without any I/O; the
+// daemon keeps at least writeback-watermark of them around.
+bool DemandPagingAllocator::needsWriteback() const {
+    return dirtyFrames > 0 && config.num_frames - dirtyFrames < config.writeback_watermark;
+}
+
+// Blocks until the batch in flight has landed if it holds this page, so
+// loads never see an older copy and synchronous writes are never
+// overtaken by the daemon's.
+void DemandPagingAllocator::waitForWritebackLocked(int processId, int pageNumber) {
+    if (!writebackInFlight.count(makePageKey(processId, pageNumber))) return;
+    writebackStats.inFlightWaits++;
+    std::lock_guard<std::mutex> batchLock(writebackMutex);
+}
+
+void DemandPagingAllocator::writebackDaemon() {
+    const int pageSize = config.mem_per_frame;
+    std::unique_lock<std::mutex> lock(framesMutex);
+    while (!writebackStop) {
+        writebackCV.wait_for(lock, std::chrono::milliseconds(20),
+                             [this] { return writebackStop || needsWriteback(); });
+        if (writebackStop || !needsWriteback()) continue;
+
+        // Least recently used dirty frames first, as they are the likeliest victims
+        std::vector<int> batch;
+        for (int i = 0; i < config.num_frames; ++i) {
+            // Shared frames are written once for all their mappings, at eviction
+            const PhysicalFrame& frame = physicalFrames[i];
+            if (frame.isOccupied && frame.isDirty && frame.refCount == 1) batch.push_back(i);
+        }
+        size_t batchSize = std::min(batch.size(), static_cast<size_t>(std::max(1, config.writeback_batch)));
+        std::partial_sort(batch.begin(), batch.begin() + batchSize, batch.end(), [this](int a, int b) {
+            return physicalFrames[a].lastAccessTick.load() < physicalFrames[b].lastAccessTick.load();
+        });
+        batch.resize(batchSize);
+        // A page with no slot and no swap left to give it stays dirty until
+        // evicted or freed
+        batch.erase(std::remove_if(batch.begin(), batch.end(), [this](int f) {
+            return !backingStore.reserveSlot(physicalFrames[f].processId, physicalFrames[f].pageNumber);
+        }), batch.end());
+        if (batch.empty()) {
+            writebackCV.wait_for(lock, std::chrono::milliseconds(20));
+            continue;
+        }
+        std::sort(batch.begin(), batch.end(), [this](int a, int b) {
+            const PhysicalFrame& x = physicalFrames[a];
+            const PhysicalFrame& y = physicalFrames[b];
+            return x.processId != y.processId ? x.processId < y.processId : x.pageNumber < y.pageNumber;
+        });
+
+        // Snapshot under the stripe lock with no TLB mapping the pages, so no
+        // core can write mid-copy. The shootdown happens under the lock too:
+        // a resident access refills the TLB while holding it.
+        std::vector<char> data(batch.size() * pageSize);
+        std::vector<std::pair<int, int>> pages;
+        for (size_t i = 0; i < batch.size(); ++i) {
+            PhysicalFrame& frame = physicalFrames[batch[i]];
+            {
+                std::lock_guard<std::mutex> stripeLock(frameLock(batch[i]));
+                tlbShootdownLocked(frame.processId, frame.pageNumber);
+                std::memcpy(&data[i * pageSize], frameData(batch[i]), pageSize);
+                setFrameDirty(batch[i], false);
+                if (ProcessMemoryLayout* layout = layoutFor(frame.processId)) {
+                    layout->pageTable.clearFlags(frame.pageNumber, PageEntry::DIRTY);
+                }
+            }
+            writebackInFlight.insert(makePageKey(frame.processId, frame.pageNumber));
+            pages.emplace_back(frame.processId, frame.pageNumber);
+        }
+
+        std::unique_lock<std::mutex> batchLock(writebackMutex);
+        lock.unlock();
+
+        // Runs of consecutive pages of one process go out as one store
+        long long writes = 0;
+        for (size_t i = 0; i < pages.size();) {
+            size_t run = 1;
+            while (i + run < pages.size() && pages[i + run].first == pages[i].first &&
+                   pages[i + run].second == pages[i].second + static_cast<int>(run)) {
+                ++run;
+            }
+            backingStore.storePages(pages[i].first, pages[i].second, static_cast<int>(run), &data[i * pageSize]);
+            writes++;
+            i += run;
+        }
+        batchLock.unlock();
+        lock.lock();
+        for (const auto& page : pages) writebackInFlight.erase(makePageKey(page.first, page.second));
+        writebackStats.batches++;
+        writebackStats.pagesCleaned += static_cast<long long>(pages.size());
+        writebackStats.writes += writes;
+        writebackStats.largestBatch = std::max(writebackStats.largestBatch, static_cast<long long>(pages.size()));
+    }
+}
+
+WritebackStatistics DemandPagingAllocator::getWritebackStatistics() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    return writebackStats;
+}
+
+ReadaheadStatistics DemandPagingAllocator::getReadaheadStatistics() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    ReadaheadStatistics snapshot = readaheadStats;
+    snapshot.prefetchHits = prefetchHits;
+    return snapshot;
+}
+
+void DemandPagingAllocator::bindCore(int coreId) {
+    currentCore = coreId;
+}
+
+// Flushes this core's TLB when it starts running a different process.
+void DemandPagingAllocator::switchContext(int processId) {
+    if (currentCore < 0 || currentCore >= numTlbs()) return;
+    CoreTlb& tlb = *coreTlbs[currentCore];
+    if (tlb.currentProcess == processId) return;
+
+    std::lock_guard<std::mutex> tlbLock(tlb.tlbMutex);
+    for (auto& entry : tlb.entries) tlbWriteBackLocked(entry);
+    tlb.currentProcess = processId;
+    tlb.flushes++;
+}
+
+// Hands the bits an entry collected to the frame and the replacement policy
+// and invalidates it. Needs the entry's TLB mutex.
+void DemandPagingAllocator::tlbWriteBackLocked(TlbEntry& entry) {
+    if (entry.frameNumber < 0) return;
+    if (entry.dirty) {
+        setFrameDirty(entry.frameNumber, true);
+        if (ProcessMemoryLayout* layout = layoutFor(entry.processId)) {
+            layout->pageTable.setFlags(entry.pageNumber, PageEntry::DIRTY);
+        }
+    }
+    if (entry.referenced) markReferenced(entry.frameNumber);
+    entry = TlbEntry();
+}
+
+// Removes a page's translation from every core before its frame is reused.
+void DemandPagingAllocator::tlbShootdownLocked(int processId, int pageNumber) {
+    for (auto& tlb : coreTlbs) {
+        std::lock_guard<std::mutex> tlbLock(tlb->tlbMutex);
+        TlbEntry& entry = tlb->entries[pageNumber % tlb->entries.size()];
+        if (entry.processId == processId && entry.pageNumber == pageNumber) tlbWriteBackLocked(entry);
+    }
+}
+
+void DemandPagingAllocator::tlbFill(int processId, int pageNumber, int frameNumber, bool writable) {
+    if (currentCore < 0 || currentCore >= numTlbs()) return;
+    CoreTlb& tlb = *coreTlbs[currentCore];
+    std::lock_guard<std::mutex> tlbLock(tlb.tlbMutex);
+    TlbEntry& entry = tlb.entries[pageNumber % tlb.entries.size()];
+    tlbWriteBackLocked(entry);
+    entry.processId = processId;
+    entry.pageNumber = pageNumber;
+    entry.frameNumber = frameNumber;
+    entry.writable = writable;
+}
+
+// Fast path for accesses within one page whose translation this core has
+// cached. Touches neither the page table nor any shared lock; a shootdown
+// cannot free the frame while the copy holds the TLB mutex.
+bool DemandPagingAllocator::tlbAccess(int processId, int virtualAddress, char* buffer, int length, bool isWrite) {
+    if (currentCore < 0 || currentCore >= numTlbs()) return false;
+    int pageNumber = virtualAddress / config.mem_per_frame;
+    int offset = virtualAddress % config.mem_per_frame;
+    if (offset + length > config.mem_per_frame) return false;
+
+    CoreTlb& tlb = *coreTlbs[currentCore];
+    std::lock_guard<std::mutex> tlbLock(tlb.tlbMutex);
+    TlbEntry& entry = tlb.entries[pageNumber % tlb.entries.size()];
+    if (entry.processId != processId || entry.pageNumber != pageNumber || (isWrite && !entry.writable)) {
+        tlb.misses++;
+        return false;
+    }
+    tlb.hits++;
+    pageTraceRecorder.recordAccess(processId, virtualAddress, isWrite, simClock.now());
+
+    char* data = frameData(entry.frameNumber) + offset;
+    if (isWrite) {
+        std::memcpy(data, buffer, length);
+        entry.dirty = true;
+    } else {
+        std::memcpy(buffer, data, length);
+    }
+    entry.referenced = true;
+    return true;
+}
+
+// Every (pid, page) mapping the frame, its owner first.
+std::vector<std::pair<int, int>> DemandPagingAllocator::frameMappings(int frameNumber) const {
+    const PhysicalFrame& frame = physicalFrames[frameNumber];
+    std::vector<std::pair<int, int>> mappings(1, {frame.processId, frame.pageNumber});
+    mappings.insert(mappings.end(), frame.sharers.begin(), frame.sharers.end());
+    return mappings;
+}
+
+// Removes one mapping from a shared frame. If it was the owner's, a sharer
+// takes over the frame and its place in the resident sets.
+void DemandPagingAllocator::dropMappingLocked(int frameNumber, int processId, int pageNumber) {
+    PhysicalFrame& frame = physicalFrames[frameNumber];
+    if (frame.processId == processId && frame.pageNumber == pageNumber) {
+        std::pair<int, int> heir = frame.sharers.back();
+        frame.sharers.pop_back();
+        residentSets.remove(processId, frameNumber);
+        residentSets.add(heir.first, frameNumber);
+        sharedMappings[heir.first]--;
+        frame.processId = heir.first;
+        frame.pageNumber = heir.second;
+    } else {
+        frame.sharers.erase(std::find(frame.sharers.begin(), frame.sharers.end(), std::make_pair(processId, pageNumber)));
+        sharedMappings[processId]--;
+    }
+    frame.refCount--;
+}
+
+// Returns false, leaving the page resident and mapped, if it is dirty and
+// cannot be written because the backing store is full. A shared frame is
+// unmapped from every process and written once for all of them.
+bool DemandPagingAllocator::swapPageOut(int frameNumber) {
+    PhysicalFrame& frame = physicalFrames[frameNumber];
+    std::vector<std::pair<int, int>> mappings = frameMappings(frameNumber);
+    
+    // Unmap first: once the loaded bit is clear under the stripe lock, no
+    // core can start a copy into this frame, and the shootdown below drops
+    // any cached translation. Only then is the data stable enough to write.
+    for (const auto& mapping : mappings) {
+        if (ProcessMemoryLayout* layout = layoutFor(mapping.first)) {
+            std::lock_guard<std::mutex> stripeLock(frameLock(frameNumber));
+            layout->pageTable.clearFlags(mapping.second, PageEntry::LOADED);
+        }
+        tlbShootdownLocked(mapping.first, mapping.second);
+    }
     
     if (frame.isDirty) {
-        std::cout << "[Memory Manager] Swapping out dirty page " << frame.pageNumber 
-                  << " of process " << frame.processId << " from frame " << frameNumber << " to backing store.\n";
-        std::vector<int> pageData(config.mem_per_frame / sizeof(int), frameNumber); // Simplified data
-        backingStore.storePage(frame.processId, frame.pageNumber, pageData);
+        // The daemon did not clean this victim in time, so the fault pays for the write
+        bool stored;
+        {
+            LatencyTimer writebackTimer(latencyFor(FaultStage::WRITEBACK));
+            waitForWritebackLocked(frame.processId, frame.pageNumber);
+            stored = mappings.size() == 1
+                ? backingStore.storePage(frame.processId, frame.pageNumber, frameData(frameNumber))
+                : backingStore.storeShared(mappings, frameData(frameNumber));
+        }
+        if (!stored) {
+            for (const auto& mapping : mappings) {
+                if (ProcessMemoryLayout* layout = layoutFor(mapping.first)) {
+                    layout->pageTable.setFlags(mapping.second, PageEntry::LOADED);
+                }
+            }
+            return false;
+        }
+        stats.dirtyWritebacks++;
+        if (config.verbose_paging) {
+            std::cout << "[Memory Manager] Swapping out dirty page " << frame.pageNumber 
+                      << " of process " << frame.processId << " from frame " << frameNumber << " to backing store.\n";
+        }
     } else {
-        std::cout << "[Memory Manager] Evicting clean page " << frame.pageNumber 
-                  << " of process " << frame.processId << " from frame " << frameNumber << ".\n";
+        if (config.verbose_paging) {
+            std::cout << "[Memory Manager] Evicting clean page " << frame.pageNumber 
+                      << " of process " << frame.processId << " from frame " << frameNumber << ".\n";
+        }
     }
     
-    if (sessions.count(frame.processId) && sessions[frame.processId].memoryLayout) {
-        auto& pageTable = sessions[frame.processId].memoryLayout->pageTable;
-        if (frame.pageNumber < pageTable.numPages) {
-            pageTable.pages[frame.pageNumber].isLoaded = false;
-            pageTable.pages[frame.pageNumber].physicalFrame = -1;
-            pageTable.pages[frame.pageNumber].isDirty = frame.isDirty;
-        }
+    if (frame.isPrefetched) {
+        readaheadStats.wastedPrefetches++;
+        auto it = readaheadStates.find(frame.processId);
+        if (it != readaheadStates.end()) it->second.window /= 2;
+        frame.isPrefetched = false;
+    }
+    
+    for (const auto& mapping : mappings) {
+        ProcessMemoryLayout* layout = layoutFor(mapping.first);
+        if (!layout) continue;
+        PageEntry pageEntry = layout->pageTable.entry(mapping.second);
+        pageEntry.setPhysicalFrame(-1);
+        pageEntry.setDirty(frame.isDirty);
+        pageEntry.setCopyOnWrite(false);
+        layout->pageTable.store(mapping.second, pageEntry);
     }
+    for (const auto& sharer : frame.sharers) sharedMappings[sharer.first]--;
     
+    replacementPolicy->onEvict(frameNumber);
+    residentSets.remove(frame.processId, frameNumber);
     frame.processId = -1;
     frame.pageNumber = -1;
     frame.isOccupied = false;
-    frame.isDirty = false;
+    frame.refCount = 0;
+    frame.sharers.clear();
+    frame.isReferenced = false;
+    setFrameDirty(frameNumber, false);
     
-    pageReplacementCount++;
+    stats.pageReplacements++;
+    return true;
 }
 
-int DemandPagingAllocator::swapPageIn(int processId, int pageNumber) {
-    int frameNumber = -1;
-    
+// A free frame, or one freed by evicting the policy's victim. When swap is
+// full and the victim is dirty, any clean page is evicted instead; with no
+// clean page either, the frame cannot be had and a demand fault fails,
+// which terminates the faulting process. Readahead just stops short.
+int DemandPagingAllocator::takeFrameLocked(bool demand) {
     if (!freeFrames.empty()) {
-        frameNumber = freeFrames.front();
+        int frameNumber = freeFrames.front();
         freeFrames.pop();
-        fifoQueue.push(frameNumber);
-    } else {
-        if (fifoQueue.empty()) {
-            std::cerr << "Error: No frames to evict in FIFO queue.\n";
-            return -1;
-        }
-        frameNumber = fifoQueue.front();
-        fifoQueue.pop();
-        swapPageOut(frameNumber);
-        fifoQueue.push(frameNumber);
+        return frameNumber;
+    }
+    int frameNumber;
+    {
+        LatencyTimer victimTimer(latencyFor(FaultStage::VICTIM_SELECTION));
+        frameNumber = replacementPolicy->selectVictim();
     }
+    if (frameNumber == -1) {
+        // Readahead finds none once the demand fault holds the only frame
+        if (demand) std::cerr << "Error: No frames to evict.\n";
+        return -1;
+    }
+    if (swapPageOut(frameNumber)) return frameNumber;
     
-    std::cout << "[Memory Manager] Swapping in page " << pageNumber 
-              << " of process " << processId << " into frame " << frameNumber << " from backing store.\n";
-    std::vector<int> pageData = backingStore.loadPage(processId, pageNumber);
+    for (int i = 0; i < config.num_frames; ++i) {
+        if (physicalFrames[i].isOccupied && !physicalFrames[i].isDirty && swapPageOut(i)) return i;
+    }
+    if (demand) {
+        std::cerr << "Error: Out of swap space (backing-store-size " << config.backing_store_size
+                  << " bytes) and every resident page is dirty.\n";
+    }
+    return -1;
+}
+
+// Brings in count consecutive pages starting at firstPage with one
+// backing-store read. The first page is the one that faulted; the rest are
+// readahead. Frames are all taken before any is handed to the policy, so a
+// later victim can never be a frame this call is still filling. Returns
+// the first page's frame, or -1.
+int DemandPagingAllocator::swapPagesIn(int processId, int firstPage, int count) {
+    std::vector<int> frames;
+    for (int i = 0; i < count; ++i) {
+        int frameNumber = takeFrameLocked(i == 0);
+        if (frameNumber == -1) break;
+        frames.push_back(frameNumber);
+    }
+    if (frames.empty()) return -1;
+    count = static_cast<int>(frames.size());
     
-    PhysicalFrame& frame = physicalFrames[frameNumber];
-    frame.processId = processId;
-    frame.pageNumber = pageNumber;
-    frame.isOccupied = true;
-    frame.isDirty = false;
-    frame.lastAccessed = Clock::now();
+    if (config.verbose_paging) {
+        std::cout << "[Memory Manager] Swapping in page " << firstPage 
+                  << " of process " << processId << " into frame " << frames[0] << " from backing store";
+        if (count > 1) std::cout << ", reading ahead " << (count - 1) << " pages";
+        std::cout << ".\n";
+    }
     
-    auto& pageTable = sessions[processId].memoryLayout->pageTable;
-    PageEntry& pageEntry = pageTable.pages[pageNumber];
-    pageEntry.physicalFrame = frameNumber;
-    pageEntry.isLoaded = true;
-    pageEntry.isAccessed = true;
-    pageEntry.isDirty = false;
+    bool loaded;
+    {
+        LatencyTimer swapInTimer(latencyFor(FaultStage::SWAP_IN));
+        for (int i = 0; i < count; ++i) waitForWritebackLocked(processId, firstPage + i);
+        if (count == 1) {
+            loaded = backingStore.loadPage(processId, firstPage, frameData(frames[0]));
+        } else {
+            std::vector<char> data(static_cast<size_t>(count) * config.mem_per_frame);
+            loaded = backingStore.loadPages(processId, firstPage, count, data.data());
+            for (int i = 0; loaded && i < count; ++i) {
+                std::memcpy(frameData(frames[i]), &data[static_cast<size_t>(i) * config.mem_per_frame], config.mem_per_frame);
+            }
+        }
+    }
+    if (loaded && count > 1) {
+        readaheadStats.reads++;
+        readaheadStats.pagesPrefetched += count - 1;
+    }
+    if (!loaded) {
+        for (int frameNumber : frames) freeFrames.push(frameNumber);
+        return -1;
+    }
+    
+    PageTable& pageTable = layoutFor(processId)->pageTable;
+    for (int i = 0; i < count; ++i) {
+        int frameNumber = frames[i];
+        int pageNumber = firstPage + i;
+        replacementPolicy->onLoad(frameNumber, makePageKey(processId, pageNumber));
+        
+        PhysicalFrame& frame = physicalFrames[frameNumber];
+        frame.processId = processId;
+        frame.pageNumber = pageNumber;
+        frame.isOccupied = true;
+        frame.refCount = 1;
+        frame.sharers.clear();
+        residentSets.add(processId, frameNumber);
+        frame.isPrefetched = i > 0;
+        frame.isReferenced = false;
+        setFrameDirty(frameNumber, false);
+        frame.lastAccessTick = simClock.now();
+        
+        // Published last: a core that sees the loaded bit also sees the data
+        PageEntry pageEntry;
+        pageEntry.setPhysicalFrame(frameNumber);
+        pageEntry.setLoaded(true);
+        pageEntry.setAccessed(i == 0);
+        pageTable.store(pageNumber, pageEntry);
+    }
 
-    return frameNumber;
+    return frames[0];
 }
 
+int DemandPagingAllocator::swapPageIn(int processId, int pageNumber) {
+    return swapPagesIn(processId, pageNumber, 1);
+}
+
+// How many pages past pageNumber to read along with it. A fault on the
+// page right after the last one brought in doubles the process's window
+// up to readahead-max; any other fault closes it, and prefetched pages
+// evicted unused halve it. Reading ahead stops at the first page swap has
+// never held, which faults to the zero page instead of taking a frame.
+int DemandPagingAllocator::readaheadLocked(int processId, int pageNumber, const PageTable& pageTable) {
+    if (config.readahead_max <= 0 || config.page_replacement_compare) return 0;
+    
+    ReadaheadState& state = readaheadStates[processId];
+    if (pageNumber == state.nextPage) {
+        state.window = std::min(config.readahead_max, std::max(1, state.window * 2));
+    } else {
+        state.window = 0;
+    }
+    
+    int ahead = 0;
+    while (ahead < state.window && pageNumber + ahead + 1 < pageTable.numPages &&
+           !pageTable.entry(pageNumber + ahead + 1).isLoaded() &&
+           (zeroFrame == -1 || backingStore.holdsPage(processId, pageNumber + ahead + 1))) {
+        ++ahead;
+    }
+    state.nextPage = pageNumber + ahead + 1;
+    return ahead;
+}
+
+// Service time includes the wait for framesMutex, so callers start the
+// clock before locking and handlePageFaultLocked does not time itself.
 bool DemandPagingAllocator::handlePageFault(int processId, int pageNumber) {
+    LatencyTimer serviceTimer(latencyFor(FaultStage::SERVICE));
     std::lock_guard<std::mutex> lock(framesMutex);
+    return handlePageFaultLocked(processId, pageNumber, false);
+}
+
+// A read of a page that was never stored maps the zero page instead of
+// taking a frame; a write to one gets a zero-filled frame of its own.
+bool DemandPagingAllocator::handlePageFaultLocked(int processId, int pageNumber, bool isWrite) {
+    stats.pageFaults++;
+    if (config.verbose_paging) {
+        std::cout << "[Memory Manager] Page fault for process " << processId 
+                  << ", page " << pageNumber << ". Total faults: " << stats.pageFaults << "\n";
+    }
     
-    pageFaultCount++;
-    std::cout << "[Memory Manager] Page fault for process " << processId 
-              << ", page " << pageNumber << ". Total faults: " << pageFaultCount << "\n";
-    
-    if (sessions.find(processId) == sessions.end() || !sessions[processId].memoryLayout) {
+    ProcessMemoryLayout* layout = layoutFor(processId);
+    if (!layout) {
         std::cerr << "Error: Process " << processId << " not found for page fault handling.\n";
         return false;
     }
     
-    auto& pageTable = sessions[processId].memoryLayout->pageTable;
+    PageTable& pageTable = layout->pageTable;
     if (pageNumber >= pageTable.numPages) {
         std::cerr << "Error: Invalid page number " << pageNumber << " for process " << processId << ".\n";
         return false;
     }
     
-    int frameNumber = swapPageIn(processId, pageNumber);
+    if (!isWrite && zeroFrame != -1 && !backingStore.holdsPage(processId, pageNumber)) {
+        PageEntry pageEntry;
+        pageEntry.setPhysicalFrame(zeroFrame);
+        pageEntry.setLoaded(true);
+        pageEntry.setAccessed(true);
+        pageEntry.setCopyOnWrite(true);
+        pageTable.store(pageNumber, pageEntry);
+        sharedMappings[processId]++;
+        dedupStats.zeroMappings++;
+        dedupStats.zeroFills++;
+        // Readahead stopped short of this page; the scan is still sequential
+        auto readahead = readaheadStates.find(processId);
+        if (readahead != readaheadStates.end() && readahead->second.nextPage == pageNumber) {
+            readahead->second.nextPage++;
+        }
+        if (config.verbose_paging) {
+            std::cout << "[Memory Manager] Mapped page " << pageNumber << " of process " << processId
+                      << " to the zero page.\n";
+        }
+        return true;
+    }
+    
+    majorFaults++;
+    faultsByProcess[processId]++;
+    drainAccessLogsLocked();
+    replacementPolicy->onMiss(makePageKey(processId, pageNumber));
+    int ahead = readaheadLocked(processId, pageNumber, pageTable);
+    int frameNumber = swapPagesIn(processId, pageNumber, 1 + ahead);
     
     return frameNumber != -1;
 }
 
-bool DemandPagingAllocator::accessMemory(int processId, int virtualAddress, bool isWrite) {
-    if (sessions.find(processId) == sessions.end() || 
-        !sessions[processId].memoryLayout) {
-        return false;
-    }
+// Serves an access to a page already in memory with only its frame's
+// stripe lock. Returns false if the page is not resident, or stopped being
+// resident before the lock was taken; the caller then faults it in.
+bool DemandPagingAllocator::residentAccess(int processId, PageTable& pageTable, int pageNumber, int offset,
+                                           char* buffer, int length, bool isWrite) {
+    PageEntry pageEntry = pageTable.entry(pageNumber);
+    if (!pageEntry.isLoaded()) return false;
+    int frameNumber = pageEntry.physicalFrame();
     
-    auto& pageTable = sessions[processId].memoryLayout->pageTable;
-    int pageNumber = virtualAddress / config.mem_per_frame;
+    std::lock_guard<std::mutex> stripeLock(frameLock(frameNumber));
+    pageEntry = pageTable.entry(pageNumber);
+    if (!pageEntry.isLoaded() || pageEntry.physicalFrame() != frameNumber) return false;
+    if (isWrite && pageEntry.isCopyOnWrite()) return false;
     
-    if (pageNumber >= pageTable.numPages) {
+    char* data = frameData(frameNumber) + offset;
+    if (isWrite) {
+        std::memcpy(data, buffer, length);
+        setFrameDirty(frameNumber, true);
+        if (!pageEntry.isDirty() || !pageEntry.isAccessed()) {
+            pageTable.setFlags(pageNumber, PageEntry::DIRTY | PageEntry::ACCESSED);
+        }
+    } else {
+        std::memcpy(buffer, data, length);
+        if (!pageEntry.isAccessed()) pageTable.setFlags(pageNumber, PageEntry::ACCESSED);
+    }
+    noteFrameAccess(frameNumber);
+    markReferenced(frameNumber);
+    residentHits++;
+    tlbFill(processId, pageNumber, frameNumber, !pageEntry.isCopyOnWrite());
+    return true;
+}
+
+// Copies length bytes between buffer and the process's virtual memory,
+// faulting pages in as needed. Resident pages are served under their
+// stripe lock alone; faults take framesMutex and keep it through the copy
+// so the page cannot be evicted in between.
+bool DemandPagingAllocator::accessMemory(int processId, int virtualAddress, char* buffer, int length, bool isWrite) {
+    if (virtualAddress >= 0 && tlbAccess(processId, virtualAddress, buffer, length, isWrite)) {
+        return true;
+    }
+    
+    ProcessMemoryLayout* layout = layoutFor(processId);
+    if (!layout || virtualAddress < 0) {
         return false;
     }
     
-    PageEntry& pageEntry = pageTable.pages[pageNumber];
+    PageTable& pageTable = layout->pageTable;
+    // Shadow pagers must see every access in order, so compare mode never bypasses the lock
+    bool bypass = !config.page_replacement_compare;
     
-    if (!pageEntry.isLoaded) {
-        if (!handlePageFault(processId, pageNumber)) {
+    while (length > 0) {
+        int pageNumber = virtualAddress / config.mem_per_frame;
+        int offset = virtualAddress % config.mem_per_frame;
+        int chunk = std::min(length, config.mem_per_frame - offset);
+        
+        if (pageNumber >= pageTable.numPages) {
             return false;
         }
+        
+        if (bypass && residentAccess(processId, pageTable, pageNumber, offset, buffer, chunk, isWrite)) {
+            pageTraceRecorder.recordAccess(processId, virtualAddress, isWrite, simClock.now());
+            virtualAddress += chunk;
+            buffer += chunk;
+            length -= chunk;
+            continue;
+        }
+        
+        // The fault's service time includes the wait for framesMutex, but the
+        // system clock is only read for accesses that look like they will fault
+        auto mayFault = [&] {
+            PageEntry page = pageTable.entry(pageNumber);
+            return !page.isLoaded() || (isWrite && page.isCopyOnWrite());
+        };
+        bool timed = mayFault();
+        std::chrono::steady_clock::time_point waitStart;
+        if (timed) waitStart = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(framesMutex);
+        pageTraceRecorder.recordAccess(processId, virtualAddress, isWrite, simClock.now());
+        for (auto& shadow : shadowPagers) shadow->access(processId, pageNumber, isWrite);
+        // Evicted or marked copy-on-write while this core waited for the lock
+        if (!timed && mayFault()) waitStart = std::chrono::steady_clock::now();
+        
+        stats.accesses++;
+        long long faultsBefore = stats.pageFaults;
+        bool mapped = true;
+        if (pageTable.entry(pageNumber).isLoaded()) {
+            // Faulted in by another core since the check above
+            stats.hits++;
+            int frameNumber = pageTable.entry(pageNumber).physicalFrame();
+            if (frameNumber != zeroFrame) replacementPolicy->onAccess(frameNumber);
+        } else {
+            mapped = handlePageFaultLocked(processId, pageNumber, isWrite);
+        }
+        if (mapped && isWrite && pageTable.entry(pageNumber).isCopyOnWrite()) {
+            mapped = breakCopyOnWriteLocked(processId, pageTable, pageNumber);
+        }
+        // A copy-on-write break whose frame was evicted faults too
+        if (stats.pageFaults != faultsBefore) latencyFor(FaultStage::SERVICE).recordSince(waitStart);
+        if (!mapped) return false;
+        
+        // Only the simulation tick is read here; no system clock call per access
+        int frameNumber = pageTable.entry(pageNumber).physicalFrame();
+        {
+            std::lock_guard<std::mutex> stripeLock(frameLock(frameNumber));
+            char* data = frameData(frameNumber) + offset;
+            if (isWrite) {
+                std::memcpy(data, buffer, chunk);
+                setFrameDirty(frameNumber, true);
+                pageTable.setFlags(pageNumber, PageEntry::DIRTY | PageEntry::ACCESSED);
+            } else {
+                std::memcpy(buffer, data, chunk);
+                pageTable.setFlags(pageNumber, PageEntry::ACCESSED);
+            }
+            noteFrameAccess(frameNumber);
+            tlbFill(processId, pageNumber, frameNumber, !pageTable.entry(pageNumber).isCopyOnWrite());
+        }
+        
+        virtualAddress += chunk;
+        buffer += chunk;
+        length -= chunk;
+    }
+    
+    return true;
+}
+
+// Gives the process's writer its own copy of a copy-on-write page. A frame
+// nobody else maps any more is just made writable; the zero page never is.
+bool DemandPagingAllocator::breakCopyOnWriteLocked(int processId, PageTable& pageTable, int pageNumber) {
+    int shared = pageTable.entry(pageNumber).physicalFrame();
+    PhysicalFrame& source = physicalFrames[shared];
+    bool fromZero = shared == zeroFrame;
+    if (!fromZero && source.refCount == 1) {
+        pageTable.clearFlags(pageNumber, PageEntry::COPY_ON_WRITE);
+        return true;
+    }
+    
+    int copy = takeFrameLocked(true);
+    if (copy == -1) return false;
+    if (!pageTable.entry(pageNumber).isLoaded()) {
+        // The shared frame itself was the victim; reading the page back gives a private frame
+        freeFrames.push(copy);
+        return handlePageFaultLocked(processId, pageNumber, true);
     }
     
+    std::memcpy(frameData(copy), frameData(shared), config.mem_per_frame);
+    tlbShootdownLocked(processId, pageNumber);
+    if (fromZero) {
+        sharedMappings[processId]--;
+        dedupStats.zeroMappings--;
+    } else {
+        dropMappingLocked(shared, processId, pageNumber);
+    }
+    
+    replacementPolicy->onLoad(copy, makePageKey(processId, pageNumber));
+    PhysicalFrame& frame = physicalFrames[copy];
+    frame.processId = processId;
+    frame.pageNumber = pageNumber;
+    frame.isOccupied = true;
+    frame.refCount = 1;
+    frame.sharers.clear();
+    residentSets.add(processId, copy);
+    frame.isPrefetched = false;
+    frame.isReferenced = false;
+    setFrameDirty(copy, source.isDirty);
+    frame.lastAccessTick = simClock.now();
+    
+    PageEntry pageEntry;
+    pageEntry.setPhysicalFrame(copy);
+    pageEntry.setLoaded(true);
+    pageEntry.setAccessed(true);
+    pageEntry.setDirty(source.isDirty);
+    pageTable.store(pageNumber, pageEntry);
+    
+    if (fromZero) {
+        dedupStats.zeroCopies++;
+    } else {
+        cowStats.copies++;
+    }
+    if (config.verbose_paging) {
+        std::cout << "[Memory Manager] Copy-on-write: page " << pageNumber << " of process " << processId
+                  << " copied from " << (fromZero ? "the zero page" : "frame " + std::to_string(shared))
+                  << " to frame " << copy << ".\n";
+    }
+    return true;
+}
+
+// Maps every resident page of the parent into the child copy-on-write and
+// lets the child share the parent's swap slots, so the child starts with
+// the parent's memory without a single page being copied. The child's
+// layout must be registered and the same size as the parent's.
+bool DemandPagingAllocator::cloneProcess(int parentId, int childId) {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    // No batch may be writing the parent's pages while their slots are shared
+    std::lock_guard<std::mutex> batchLock(writebackMutex);
+    ProcessMemoryLayout* parent = layoutFor(parentId);
+    ProcessMemoryLayout* child = layoutFor(childId);
+    if (!parent) {
+        // Unregistered when its pages were freed, so its entries are gone too
+        std::cerr << "Error: Process " << parentId << " has finished and cannot be cloned.\n";
+        return false;
+    }
+    if (!child || parent->pageTable.numPages != child->pageTable.numPages) {
+        std::cerr << "Error: Cannot clone process " << parentId << " into process " << childId << ".\n";
+        return false;
+    }
+    
+    backingStore.cloneProcess(parentId, childId);
+    int shared = 0;
+    int zeroPages = 0;
+    parent->pageTable.forEachLoaded([&](int pageNumber, PageEntry parentEntry) {
+        int frameNumber = parentEntry.physicalFrame();
+        if (frameNumber == zeroFrame) {
+            child->pageTable.store(pageNumber, parentEntry);
+            zeroPages++;
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> stripeLock(frameLock(frameNumber));
+            parent->pageTable.setFlags(pageNumber, PageEntry::COPY_ON_WRITE);
+        }
+        // Drops writable translations; dirty bits they collected reach the frame
+        tlbShootdownLocked(parentId, pageNumber);
+        
+        PhysicalFrame& frame = physicalFrames[frameNumber];
+        frame.sharers.emplace_back(childId, pageNumber);
+        frame.refCount++;
+        
+        PageEntry childEntry;
+        childEntry.setPhysicalFrame(frameNumber);
+        childEntry.setLoaded(true);
+        childEntry.setCopyOnWrite(true);
+        child->pageTable.store(pageNumber, childEntry);
+        shared++;
+    });
+    sharedMappings[childId] += shared + zeroPages;
+    dedupStats.zeroMappings += zeroPages;
+    cowStats.clones++;
+    cowStats.framesShared += shared;
+    return true;
+}
+
+void DemandPagingAllocator::dedupScanner() {
+    std::unique_lock<std::mutex> lock(framesMutex);
+    while (!dedupStop) {
+        dedupCV.wait_for(lock, std::chrono::milliseconds(std::max(1, config.dedup_sleep_ms)),
+                         [this] { return dedupStop; });
+        if (!dedupStop) dedupPassLocked();
+    }
+}
+
+// Hashes up to dedup-scan-pages clean frames. A frame equal to the zero
+// page, or to a frame indexed earlier in the sweep, is merged into it.
+// Dirty frames are skipped; they are still being written.
+void DemandPagingAllocator::dedupPassLocked() {
+    const int pageSize = config.mem_per_frame;
+    unsigned long long zeroHash = hashPage(frameData(zeroFrame), pageSize);
+    int budget = config.dedup_scan_pages;
+    for (int visited = 0; visited < config.num_frames && budget > 0; ++visited) {
+        if (dedupCursor >= config.num_frames) {
+            dedupCursor = 0;
+            dedupIndex.clear();
+        }
+        int frameNumber = dedupCursor++;
+        const PhysicalFrame& frame = physicalFrames[frameNumber];
+        if (!frame.isOccupied || frame.isDirty) continue;
+        budget--;
+        dedupStats.pagesScanned++;
+        
+        unsigned long long hash;
+        {
+            // No core may write the page while it is hashed
+            std::lock_guard<std::mutex> stripeLock(frameLock(frameNumber));
+            for (const auto& mapping : frameMappings(frameNumber)) tlbShootdownLocked(mapping.first, mapping.second);
+            if (frame.isDirty) continue;
+            hash = hashPage(frameData(frameNumber), pageSize);
+        }
+        
+        if (hash == zeroHash) {
+            mergeFramesLocked(zeroFrame, frameNumber);
+            continue;
+        }
+        auto indexed = dedupIndex.find(hash);
+        if (indexed == dedupIndex.end() || !mergeFramesLocked(indexed->second, frameNumber)) {
+            // The indexed frame changed or left since it was hashed; this one replaces it
+            dedupIndex[hash] = frameNumber;
+        }
+    }
+    dedupStats.passes++;
+}
+
+// Points every mapping of duplicate at keeper, copy-on-write, and frees
+// duplicate. Nothing changes unless both are clean and hold the same bytes
+// once no core can write either. Only the scanner holds two stripe locks,
+// and framesMutex keeps it to one pass at a time.
+bool DemandPagingAllocator::mergeFramesLocked(int keeper, int duplicate) {
+    PhysicalFrame& kept = physicalFrames[keeper];
+    PhysicalFrame& frame = physicalFrames[duplicate];
+    bool toZero = keeper == zeroFrame;
+    if (keeper == duplicate || (!toZero && !kept.isOccupied)) return false;
+    
+    std::vector<std::pair<int, int>> moved = frameMappings(duplicate);
+    std::vector<std::pair<int, int>> keptMappings;
+    if (!toZero) keptMappings = frameMappings(keeper);
     {
-        std::lock_guard<std::mutex> lock(framesMutex);
-        if (pageEntry.physicalFrame >= 0 && pageEntry.physicalFrame < config.num_frames) {
-            physicalFrames[pageEntry.physicalFrame].lastAccessed = Clock::now();
-            if (isWrite) {
-                physicalFrames[pageEntry.physicalFrame].isDirty = true;
-                pageEntry.isDirty = true;
+        std::unique_lock<std::mutex> keeperLock(frameLock(keeper));
+        std::unique_lock<std::mutex> duplicateLock(frameLock(duplicate), std::defer_lock);
+        if (&frameLock(duplicate) != &frameLock(keeper)) duplicateLock.lock();
+        for (const auto& mapping : keptMappings) tlbShootdownLocked(mapping.first, mapping.second);
+        for (const auto& mapping : moved) tlbShootdownLocked(mapping.first, mapping.second);
+        if (kept.isDirty || frame.isDirty ||
+            std::memcmp(frameData(keeper), frameData(duplicate), config.mem_per_frame) != 0) {
+            return false;
+        }
+        
+        for (const auto& mapping : keptMappings) {
+            if (ProcessMemoryLayout* layout = layoutFor(mapping.first)) {
+                layout->pageTable.setFlags(mapping.second, PageEntry::COPY_ON_WRITE);
             }
         }
+        for (const auto& mapping : moved) {
+            ProcessMemoryLayout* layout = layoutFor(mapping.first);
+            if (!layout) continue;
+            PageEntry pageEntry = layout->pageTable.entry(mapping.second);
+            pageEntry.setPhysicalFrame(keeper);
+            pageEntry.setCopyOnWrite(true);
+            layout->pageTable.store(mapping.second, pageEntry);
+        }
     }
     
-    pageEntry.isAccessed = true;
+    if (config.verbose_paging) {
+        std::cout << "[Memory Manager] Merged page " << frame.pageNumber << " of process " << frame.processId
+                  << " into " << (toZero ? "the zero page" : "frame " + std::to_string(keeper))
+                  << ", freeing frame " << duplicate << ".\n";
+    }
+    // The duplicate's owner now maps a frame it does not own; its sharers already did
+    sharedMappings[frame.processId]++;
+    if (toZero) {
+        dedupStats.zeroMappings += static_cast<int>(moved.size());
+        dedupStats.zeroMerges++;
+    } else {
+        kept.sharers.insert(kept.sharers.end(), moved.begin(), moved.end());
+        kept.refCount += static_cast<int>(moved.size());
+    }
+    dedupStats.merges++;
     
+    replacementPolicy->onFree(duplicate);
+    residentSets.remove(frame.processId, duplicate);
+    frame.processId = -1;
+    frame.pageNumber = -1;
+    frame.isOccupied = false;
+    frame.refCount = 0;
+    frame.sharers.clear();
+    frame.isPrefetched = false;
+    frame.isReferenced = false;
+    freeFrames.push(duplicate);
     return true;
 }
 
+DedupStatistics DemandPagingAllocator::getDedupStatistics() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    return dedupStats;
+}
+
+// Costs time proportional to the process's resident set, not to the
+// number of frames. Frames the process shares with clones stay resident
+// for the processes still mapping them.
 void DemandPagingAllocator::freeProcessPages(int processId) {
     std::lock_guard<std::mutex> lock(framesMutex);
+    auto dropTranslation = [this, processId](int pageNumber) {
+        // Only resident pages can be cached, so dropping their entries clears the TLBs
+        for (auto& tlb : coreTlbs) {
+            std::lock_guard<std::mutex> tlbLock(tlb->tlbMutex);
+            TlbEntry& entry = tlb->entries[pageNumber % tlb->entries.size()];
+            if (entry.processId == processId && entry.pageNumber == pageNumber) entry = TlbEntry();
+        }
+    };
     
-    std::queue<int> newFifoQueue;
-    while(!fifoQueue.empty()){
-        int frameIdx = fifoQueue.front();
-        fifoQueue.pop();
-        if(physicalFrames[frameIdx].processId != processId){
-            newFifoQueue.push(frameIdx);
+    // Mappings on frames owned by others are only found through the page table
+    auto shared = sharedMappings.find(processId);
+    if (shared != sharedMappings.end()) {
+        ProcessMemoryLayout* layout = shared->second > 0 ? layoutFor(processId) : nullptr;
+        if (layout) {
+            layout->pageTable.forEachLoaded([&](int pageNumber, PageEntry pageEntry) {
+                const PhysicalFrame& frame = physicalFrames[pageEntry.physicalFrame()];
+                if (!pageEntry.isCopyOnWrite() || (frame.processId == processId && frame.pageNumber == pageNumber)) return;
+                dropTranslation(pageNumber);
+                if (pageEntry.physicalFrame() == zeroFrame) {
+                    dedupStats.zeroMappings--;
+                } else {
+                    dropMappingLocked(pageEntry.physicalFrame(), processId, pageNumber);
+                }
+            });
         }
+        sharedMappings.erase(processId);
     }
-    fifoQueue = newFifoQueue;
-
-    for (int i = 0; i < config.num_frames; ++i) {
-        if (physicalFrames[i].isOccupied && physicalFrames[i].processId == processId) {
-            physicalFrames[i].processId = -1;
-            physicalFrames[i].pageNumber = -1;
-            physicalFrames[i].isOccupied = false;
-            physicalFrames[i].isDirty = false;
-            freeFrames.push(i);
+    
+    for (int i : residentSets.take(processId)) {
+        PhysicalFrame& frame = physicalFrames[i];
+        dropTranslation(frame.pageNumber);
+        if (frame.refCount > 1) {
+            // take() already unlinked the frame, so the heir is added afresh
+            std::pair<int, int> heir = frame.sharers.back();
+            frame.sharers.pop_back();
+            sharedMappings[heir.first]--;
+            frame.processId = heir.first;
+            frame.pageNumber = heir.second;
+            frame.refCount--;
+            residentSets.add(heir.first, i);
+            continue;
+        }
+        replacementPolicy->onFree(i);
+        frame.processId = -1;
+        frame.pageNumber = -1;
+        frame.isOccupied = false;
+        frame.refCount = 0;
+        if (frame.isPrefetched.exchange(false)) readaheadStats.wastedPrefetches++;
+        frame.isReferenced = false;
+        setFrameDirty(i, false);
+        freeFrames.push(i);
+    }
+    readaheadStates.erase(processId);
+    faultsByProcess.erase(processId);
+    {
+        // Its entries still point at the frames just freed. Cleared and
+        // unregistered, they can no longer be reached by the daemons or
+        // handed to a clone.
+        std::lock_guard<std::shared_timed_mutex> layoutsLock(layoutsMutex);
+        auto it = layouts.find(processId);
+        if (it != layouts.end()) {
+            PageTable& pageTable = it->second->pageTable;
+            pageTable.forEachLoaded([&pageTable](int pageNumber, PageEntry) { pageTable.store(pageNumber, PageEntry()); });
+            layouts.erase(it);
         }
     }
+    pageTraceRecorder.recordExit(processId, simClock.now());
+    for (auto& shadow : shadowPagers) shadow->releaseProcess(processId);
+    // A batch still writing this process's pages would claim slots again after the release
+    if (!writebackInFlight.empty()) {
+        std::lock_guard<std::mutex> batchLock(writebackMutex);
+    }
+    backingStore.releaseProcess(processId);
 }
 
-void DemandPagingAllocator::getStatistics(int& pageFaults, int& pageReplacements, int& framesUsed) {
+// Swaps out every frame the process owns alone, so a process the scheduler
+// holds back gives its memory to the ones still running. Frames shared
+// with clones stay resident for them, and a dirty page that does not fit
+// in swap stays too. In compare mode nothing is swapped out, since the
+// shadow pagers would never see the pages go. Returns the number of
+// frames freed.
+int DemandPagingAllocator::suspendProcess(int processId) {
     std::lock_guard<std::mutex> lock(framesMutex);
-    pageFaults = pageFaultCount;
-    pageReplacements = pageReplacementCount;
-    framesUsed = config.num_frames - freeFrames.size();
+    int freed = 0;
+    if (config.page_replacement_compare) return freed;
+    for (int i : residentSets.frames(processId)) {
+        if (physicalFrames[i].refCount > 1 || !swapPageOut(i)) continue;
+        freeFrames.push(i);
+        freed++;
+    }
+    readaheadStates.erase(processId);
+    if (config.verbose_paging) {
+        std::cout << "[Memory Manager] Swapped out " << freed << " pages of suspended process " << processId << ".\n";
+    }
+    return freed;
 }
 
-void DemandPagingAllocator::displayFrameTable() {
+MemoryPressure DemandPagingAllocator::getMemoryPressure() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    MemoryPressure snapshot;
+    snapshot.faults = majorFaults;
+    snapshot.freeFrames = static_cast<int>(freeFrames.size());
+    for (const auto& entry : faultsByProcess) {
+        snapshot.processes.push_back({entry.first, entry.second, residentSets.count(entry.first)});
+    }
+    return snapshot;
+}
+
+CopyOnWriteStatistics DemandPagingAllocator::getCopyOnWriteStatistics() {
     std::lock_guard<std::mutex> lock(framesMutex);
+    CopyOnWriteStatistics snapshot = cowStats;
+    for (const auto& frame : physicalFrames) {
+        if (frame.refCount <= 1) continue;
+        snapshot.sharedFrames++;
+        snapshot.mappingsSaved += frame.refCount - 1;
+    }
+    return snapshot;
+}
+
+PagingStatistics DemandPagingAllocator::getStatistics() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    PagingStatistics snapshot = stats;
+    snapshot.accesses += residentHits;
+    snapshot.hits += residentHits;
+    for (const auto& tlb : coreTlbs) {
+        snapshot.accesses += tlb->hits;
+        snapshot.hits += tlb->hits;
+    }
+    snapshot.framesUsed = config.num_frames - static_cast<int>(freeFrames.size());
+    return snapshot;
+}
+
+void DemandPagingAllocator::displayFrameTable() {
+    std::unique_lock<std::mutex> lock(framesMutex);
     
     std::cout << "\n===== PHYSICAL FRAME TABLE =====\n";
-    std::cout << "Frame# | Process ID | Page# | Occupied | Dirty | Last Accessed\n";
-    std::cout << "-------|------------|-------|----------|-------|---------------\n";
+    std::cout << "Frame# | Process ID | Page# | Occupied | Dirty | Refs | Last Accessed\n";
+    std::cout << "-------|------------|-------|----------|-------|------|---------------\n";
     
     for (int i = 0; i < config.num_frames; ++i) {
         const auto& frame = physicalFrames[i];
@@ -234,48 +1202,73 @@ void DemandPagingAllocator::displayFrameTable() {
             std::cout << std::setw(5) << frame.pageNumber << " | ";
             std::cout << std::setw(8) << "Yes" << " | ";
             std::cout << std::setw(5) << (frame.isDirty ? "Yes" : "No") << " | ";
+            std::cout << std::setw(4) << frame.refCount << " | ";
             
-            auto time_t_val = Clock::to_time_t(frame.lastAccessed);
-            std::tm* tm = std::localtime(&time_t_val);
-            std::cout << std::setfill('0')
-                    << std::setw(2) << tm->tm_hour << ':'
-                    << std::setw(2) << tm->tm_min << ':'
-                    << std::setw(2) << tm->tm_sec;
-            std::cout << std::setfill(' ');
+            std::cout << "tick " << frame.lastAccessTick.load();
         } else {
             std::cout << std::setw(10) << "N/A" << " | ";
             std::cout << std::setw(5) << "N/A" << " | ";
             std::cout << std::setw(8) << "No" << " | ";
             std::cout << std::setw(5) << "N/A" << " | ";
+            std::cout << std::setw(4) << 0 << " | ";
             std::cout << "N/A";
         }
         std::cout << "\n";
     }
+    lock.unlock();
+    
+    PagingStatistics current = getStatistics();
     
-    int pageFaults, pageReplacements, framesUsed;
-    getStatistics(pageFaults, pageReplacements, framesUsed);
+    std::cout << "\nSTATISTICS (" << config.page_replacement << "):\n";
+    std::cout << "  Total Page Faults: " << current.pageFaults << "\n";
+    std::cout << "  Page Replacements: " << current.pageReplacements << "\n";
+    std::cout << "  Dirty Write-backs: " << current.dirtyWritebacks << "\n";
+    std::cout << "  Hit Ratio: " << std::fixed << std::setprecision(2) << current.hitRatio() * 100 << "%\n";
+    std::cout.unsetf(std::ios::fixed);
+    std::cout << "  Frames Used: " << current.framesUsed << "/" << config.num_frames << "\n";
+    std::cout << "  Free Frames: " << (config.num_frames - current.framesUsed) << "\n";
+    SwapUsage swap = backingStore.usage();
+    std::cout << "  Pages in Backing Store: " << swap.slotsUsed << "/" << swap.capacitySlots << "\n\n";
     
-    std::cout << "\nSTATISTICS:\n";
-    std::cout << "  Total Page Faults: " << pageFaults << "\n";
-    std::cout << "  Page Replacements: " << pageReplacements << "\n";
-    std::cout << "  Frames Used: " << framesUsed << "/" << config.num_frames << "\n";
-    std::cout << "  Free Frames: " << (config.num_frames - framesUsed) << "\n\n";
+    displayPolicyComparison();
+}
+
+// One row per policy, the live one first, for the same page accesses.
+void DemandPagingAllocator::displayPolicyComparison() {
+    std::lock_guard<std::mutex> lock(framesMutex);
+    if (shadowPagers.empty()) return;
+    
+    auto printRow = [](const std::string& name, const PagingStatistics& row) {
+        std::cout << std::left << std::setw(10) << name << std::right << " | "
+                  << std::setw(12) << row.pageFaults << " | "
+                  << std::setw(12) << row.pageReplacements << " | "
+                  << std::setw(11) << row.dirtyWritebacks << " | "
+                  << std::fixed << std::setprecision(2) << std::setw(8) << row.hitRatio() * 100 << "%\n";
+        std::cout.unsetf(std::ios::fixed);
+    };
+    
+    std::cout << "POLICY COMPARISON (same access stream):\n";
+    std::cout << "Policy     |  Page Faults | Replacements | Write-backs | Hit Ratio\n";
+    std::cout << "-----------|--------------|--------------|-------------|----------\n";
+    printRow(config.page_replacement + "*", stats);
+    for (const auto& shadow : shadowPagers) printRow(shadow->name(), shadow->statistics());
+    std::cout << "\n";
 }
 
 bool readMemory(int processId, int virtualAddress, int& value) {
-    if (demandPagingAllocator.accessMemory(processId, virtualAddress, false)) {
-        value = virtualAddress % 1000;
-        return true;
-    }
-    return false;
+    return demandPagingAllocator.accessMemory(processId, virtualAddress,
+                                              reinterpret_cast<char*>(&value), sizeof(int), false);
 }
 
 bool writeMemory(int processId, int virtualAddress, int value) {
-    return demandPagingAllocator.accessMemory(processId, virtualAddress, true);
+    return demandPagingAllocator.accessMemory(processId, virtualAddress,
+                                              reinterpret_cast<char*>(&value), sizeof(int), true);
 }
 
-void createProcessMemoryLayout(int pid, int memorySize) {
+void createProcessMemoryLayout(int pid, int memorySize, bool announce) {
     sessions[pid].memoryLayout = std::make_unique<ProcessMemoryLayout>(memorySize);
+    demandPagingAllocator.registerProcess(pid, sessions[pid].memoryLayout.get());
+    if (!announce) return;
     
     std::cout << "Created memory layout for process " << pid << ":\n";
     std::cout << "  Total memory: " << memorySize << " bytes\n";
@@ -291,6 +1284,8 @@ void createProcessMemoryLayout(int pid, int memorySize) {
 }
 
 void displayPageTable(int pid) {
+    // The generator adds to sessions and processNames under sessionMutex
+    std::lock_guard<std::mutex> lock(sessionMutex);
     if (sessions.find(pid) == sessions.end() || !sessions[pid].memoryLayout) {
         std::cout << "Process " << pid << " not found or has no memory layout.\n";
         return;
@@ -299,29 +1294,36 @@ void displayPageTable(int pid) {
     const auto& pageTable = sessions[pid].memoryLayout->pageTable;
     std::cout << "Page Table for Process " << pid << " (" << processNames[pid] << "):\n";
     std::cout << "Total Pages: " << pageTable.numPages << "\n";
-    std::cout << "Page Size: " << config.mem_per_frame << " bytes\n\n";
+    std::cout << "Page Size: " << config.mem_per_frame << " bytes\n";
+    std::cout << "Leaf Tables: " << pageTable.leavesAllocated() << " of " << pageTable.leafSlots()
+              << " allocated (" << pageTable.overheadBytes() << " bytes)\n\n";
     
-    std::cout << "Page# | Physical Frame | Loaded | Dirty | Accessed\n";
-    std::cout << "------|----------------|--------|-------|----------\n";
+    std::cout << "Page# | Physical Frame | Loaded | Dirty | Accessed | COW\n";
+    std::cout << "------|----------------|--------|-------|----------|-----\n";
     
     for (int i = 0; i < pageTable.numPages; ++i) {
-        const auto& page = pageTable.pages[i];
+        PageEntry page = pageTable.entry(i);
         std::cout << std::setw(5) << i << " | ";
         
-        if (page.physicalFrame == -1) {
+        if (page.physicalFrame() == -1) {
             std::cout << std::setw(14) << "N/A" << " | ";
+        } else if (page.physicalFrame() == demandPagingAllocator.zeroFrameNumber()) {
+            std::cout << std::setw(14) << "zero" << " | ";
         } else {
-            std::cout << std::setw(14) << page.physicalFrame << " | ";
+            std::cout << std::setw(14) << page.physicalFrame() << " | ";
         }
         
-        std::cout << std::setw(6) << (page.isLoaded ? "Yes" : "No") << " | ";
-        std::cout << std::setw(5) << (page.isDirty ? "Yes" : "No") << " | ";
-        std::cout << std::setw(8) << (page.isAccessed ? "Yes" : "No") << "\n";
+        std::cout << std::setw(6) << (page.isLoaded() ? "Yes" : "No") << " | ";
+        std::cout << std::setw(5) << (page.isDirty() ? "Yes" : "No") << " | ";
+        std::cout << std::setw(8) << (page.isAccessed() ? "Yes" : "No") << " | ";
+        std::cout << std::setw(3) << (page.isCopyOnWrite() ? "Yes" : "No") << "\n";
     }
     std::cout << "\n";
 }
 
 void displayMemorySegments(int pid) {
+    // The generator adds to sessions and processNames under sessionMutex
+    std::lock_guard<std::mutex> lock(sessionMutex);
     if (sessions.find(pid) == sessions.end() || !sessions[pid].memoryLayout) {
         std::cout << "Process " << pid << " not found or has no memory layout.\n";
         return;
@@ -2,40 +2,283 @@
 #define MEMORY_MANAGER_H
 
 #include "structures.h"
+#include "backing_store.h"
+#include "config.h"
+#include "page_replacement.h"
+#include "latency_histogram.h"
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <memory>
+#include <atomic>
+#include <condition_variable>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
+// One cached translation. dirty and referenced collect what hits did to the
+// page and are handed to the frame and replacement policy when the entry
+// is flushed. Copy-on-write pages are cached read-only.
+struct TlbEntry {
+    int processId = -1;
+    int pageNumber = -1;
+    int frameNumber = -1;
+    bool writable = false;
+    bool dirty = false;
+    bool referenced = false;
+};
+
+// Direct-mapped TLB private to one core, indexed by page number and tagged
+// with the pid. Hits only take this core's mutex. It is also taken to fill
+// entries after a translation and, by eviction, to shoot them down.
+struct CoreTlb {
+    std::vector<TlbEntry> entries;
+    std::mutex tlbMutex;
+    int currentProcess = -1;
+    std::atomic<long long> hits{0};
+    std::atomic<long long> misses{0};
+    std::atomic<long long> flushes{0};
+};
+
+// What the writeback daemon has done. Dirty victims the daemon did not get
+// to in time are still written during the fault; PagingStatistics counts
+// those as dirtyWritebacks.
+struct WritebackStatistics {
+    long long batches = 0;
+    long long pagesCleaned = 0;
+    long long writes = 0;            // backing-store calls after coalescing
+    long long largestBatch = 0;
+    long long inFlightWaits = 0;     // faults that waited for a batch to land
+
+    double averageBatch() const { return batches > 0 ? static_cast<double>(pagesCleaned) / batches : 0.0; }
+    double pagesPerWrite() const { return writes > 0 ? static_cast<double>(pagesCleaned) / writes : 0.0; }
+};
+
+// Per-process sequential fault detector. nextPage is the page after the
+// last one brought in; window is how many pages the next sequential fault
+// reads ahead.
+struct ReadaheadState {
+    int nextPage = -1;
+    int window = 0;
+};
+
+struct ReadaheadStatistics {
+    long long reads = 0;             // batched backing-store reads with readahead
+    long long pagesPrefetched = 0;
+    long long prefetchHits = 0;      // prefetched pages accessed before eviction
+    long long wastedPrefetches = 0;  // evicted or freed without being accessed
+
+    double accuracy() const {
+        long long settled = prefetchHits + wastedPrefetches;
+        return settled > 0 ? static_cast<double>(prefetchHits) / settled : 0.0;
+    }
+};
+
+struct CopyOnWriteStatistics {
+    long long clones = 0;
+    long long framesShared = 0;      // mappings handed to children at clone time
+    long long copies = 0;            // writes that had to copy a shared frame
+    int sharedFrames = 0;            // frames mapped by more than one page right now
+    int mappingsSaved = 0;           // frames the extra mappings would otherwise need
+
+    double copyRatio() const { return framesShared > 0 ? static_cast<double>(copies) / framesShared : 0.0; }
+};
+
+// Pages kept resident without a frame of their own: never-written pages
+// that map the zero page, and duplicates the scanner merged into a frame
+// with the same contents.
+struct DedupStatistics {
+    long long zeroFills = 0;         // read faults served by mapping the zero page
+    long long zeroCopies = 0;        // first writes that gave such a page its own frame
+    int zeroMappings = 0;            // pages mapping the zero page right now
+    long long passes = 0;
+    long long pagesScanned = 0;
+    long long merges = 0;            // frames freed by merging them into another
+    long long zeroMerges = 0;        // of those, all-zero frames merged into the zero page
+
+    double mergeRatio() const { return pagesScanned > 0 ? static_cast<double>(merges) / pagesScanned : 0.0; }
+};
+
+// What the scheduler's thrashing detector samples. Only faults that had
+// to bring a page in count; zero-page fills and copy-on-write breaks do
+// not take a frame away from anyone.
+struct ProcessPagingActivity {
+    int processId;
+    long long faults;        // since the process first ran
+    int residentPages;       // frames it owns right now
+};
+
+struct MemoryPressure {
+    long long faults = 0;    // since initialize, finished processes included
+    int freeFrames = 0;
+    std::vector<ProcessPagingActivity> processes;
+};
+
+// Parts of the fault path timed in wall-clock time. SERVICE covers a whole
+// fault including the wait for framesMutex; the others are the victim choice, the write of a dirty victim and
+// the backing-store read, each including any wait on a writeback batch.
+enum class FaultStage { VICTIM_SELECTION, WRITEBACK, SWAP_IN, SERVICE };
+const int FAULT_STAGES = 4;
+
+// One histogram per stage. Each core records into its own set, so cores
+// never share a cache line while timing faults.
+struct FaultLatencies {
+    LatencyHistogram stages[FAULT_STAGES];
+};
+
+// References a core made to resident frames without the pager's lock.
+// They are handed to the replacement policy in bulk at the next fault.
+struct AccessLog {
+    std::mutex logMutex;
+    std::vector<int> frames;
+};
+
+// Locking protocol:
+//  - framesMutex serializes faults, eviction, the free list, the policy
+//    and the backing store.
+//  - A frame's contents and its mapping are also guarded by one of
+//    FRAME_LOCK_STRIPES stripe locks. A core that finds its page loaded in
+//    the page table takes only that stripe, re-checks the entry and copies.
+//    Eviction clears the entry's loaded bit under the same stripe before
+//    touching the data, so the two never overlap.
+//  - Page-table entries and the frame dirty/referenced bits are atomic.
+//  - A frame's refCount and sharers only change under framesMutex; a
+//    write to a copy-on-write page always goes through it. Every mapping
+//    of the zero page is copy-on-write, so its frame is never written.
+//  - Lock order: framesMutex, then a stripe, then a TLB mutex, then an
+//    access log or layoutsMutex.
+// In page-replacement-compare mode every access takes framesMutex so the
+// shadow pagers see one ordered stream.
 class DemandPagingAllocator {
 private:
+    static const int FRAME_LOCK_STRIPES = 64;
+
     std::vector<PhysicalFrame> physicalFrames;
+    std::vector<char> physicalMemory;   // num-frames * mem-per-frame bytes, one slice per frame
+    std::vector<std::mutex> frameLocks;
     std::queue<int> freeFrames;
-    std::queue<int> fifoQueue;
+    ResidentSets residentSets;
     BackingStore backingStore;
     std::mutex framesMutex;
-    int pageFaultCount;
-    int pageReplacementCount;
+    std::unique_ptr<ReplacementPolicy> replacementPolicy;
+    std::vector<std::unique_ptr<PageCacheSimulator>> shadowPagers;
+    PagingStatistics stats;
+    std::atomic<long long> residentHits;   // accesses served under a stripe lock alone
+    std::vector<std::unique_ptr<AccessLog>> accessLogs;
+    std::vector<std::unique_ptr<CoreTlb>> coreTlbs;
+    std::vector<std::unique_ptr<FaultLatencies>> faultLatencies;   // per core, plus one for other threads
+
+    // Memory layouts by pid, so the paging path never reads sessions
+    std::unordered_map<int, ProcessMemoryLayout*> layouts;
+    std::shared_timed_mutex layoutsMutex;
+
+    // Writeback daemon. It snapshots dirty frames under framesMutex, then
+    // writes them holding only writebackMutex; pages in writebackInFlight
+    // must not be read from or written to the backing store until it is done.
+    std::thread writebackThread;
+    std::condition_variable writebackCV;
+    std::mutex writebackMutex;
+    std::unordered_set<PageKey> writebackInFlight;
+    bool writebackStop;
+    std::atomic<int> dirtyFrames;
+    WritebackStatistics writebackStats;
+
+    // Copy-on-write mappings each process holds on frames it does not own,
+    // the zero page included
+    std::unordered_map<int, int> sharedMappings;
+    CopyOnWriteStatistics cowStats;
+
+    // One zero-filled frame past the last of num-frames, owned by no process
+    // and never evicted. -1 in compare mode, where a fault must load a frame
+    // as it does in the shadow pagers.
+    int zeroFrame;
+
+    // Dedup scanner. It hashes a few clean frames per pass, resuming at
+    // dedupCursor, and indexes them by hash until the sweep wraps around.
+    std::thread dedupThread;
+    std::condition_variable dedupCV;
+    bool dedupStop;
+    int dedupCursor;
+    std::unordered_map<unsigned long long, int> dedupIndex;
+    DedupStatistics dedupStats;
+
+    // Faults that took a frame, in total and per live process
+    long long majorFaults;
+    std::unordered_map<int, long long> faultsByProcess;
+
+    std::unordered_map<int, ReadaheadState> readaheadStates;
+    ReadaheadStatistics readaheadStats;
+    std::atomic<long long> prefetchHits;
 
-    int findLRUFrame();
-    void swapPageOut(int frameNumber);
+    std::mutex& frameLock(int frameNumber) { return frameLocks[frameNumber % FRAME_LOCK_STRIPES]; }
+    LatencyHistogram& latencyFor(FaultStage stage);
+    ProcessMemoryLayout* layoutFor(int processId);
+    void setFrameDirty(int frameNumber, bool dirty);
+    void markReferenced(int frameNumber);
+    void drainAccessLogsLocked();
+    void noteFrameAccess(int frameNumber);
+    bool residentAccess(int processId, PageTable& pageTable, int pageNumber, int offset,
+                        char* buffer, int length, bool isWrite);
+    bool needsWriteback() const;
+    void waitForWritebackLocked(int processId, int pageNumber);
+    void writebackDaemon();
+    bool tlbAccess(int processId, int virtualAddress, char* buffer, int length, bool isWrite);
+    void tlbFill(int processId, int pageNumber, int frameNumber, bool writable);
+    void tlbWriteBackLocked(TlbEntry& entry);
+    void tlbShootdownLocked(int processId, int pageNumber);
+    std::vector<std::pair<int, int>> frameMappings(int frameNumber) const;
+    void dropMappingLocked(int frameNumber, int processId, int pageNumber);
+    bool breakCopyOnWriteLocked(int processId, PageTable& pageTable, int pageNumber);
+    void dedupScanner();
+    void dedupPassLocked();
+    bool mergeFramesLocked(int keeper, int duplicate);
+    bool swapPageOut(int frameNumber);
+    int takeFrameLocked(bool demand);
+    int swapPagesIn(int processId, int firstPage, int count);
     int swapPageIn(int processId, int pageNumber);
+    int readaheadLocked(int processId, int pageNumber, const PageTable& pageTable);
+    bool handlePageFaultLocked(int processId, int pageNumber, bool isWrite);
+    char* frameData(int frameNumber) {
+        return &physicalMemory[static_cast<size_t>(frameNumber) * config.mem_per_frame];
+    }
 
 public:
     DemandPagingAllocator();
+    void initialize();
+    void shutdown();
+    void registerProcess(int processId, ProcessMemoryLayout* layout);
+    void bindCore(int coreId);
+    void switchContext(int processId);
     bool handlePageFault(int processId, int pageNumber);
-    bool accessMemory(int processId, int virtualAddress, bool isWrite = false);
+    bool accessMemory(int processId, int virtualAddress, char* buffer, int length, bool isWrite = false);
+    bool cloneProcess(int parentId, int childId);
     void freeProcessPages(int processId);
-    void getStatistics(int& pageFaults, int& pageReplacements, int& framesUsed);
+    int suspendProcess(int processId);
+    MemoryPressure getMemoryPressure();
+    PagingStatistics getStatistics();
+    WritebackStatistics getWritebackStatistics();
+    ReadaheadStatistics getReadaheadStatistics();
+    CopyOnWriteStatistics getCopyOnWriteStatistics();
+    DedupStatistics getDedupStatistics();
+    int zeroFrameNumber() const { return zeroFrame; }
+    SwapUsage getSwapUsage() { return backingStore.usage(); }
+    CompressedSwapStatistics getCompressedSwapStatistics() { return backingStore.compressedStatistics(); }
     void displayFrameTable();
+    void displayPolicyComparison();
+    // Stage latencies of one core's faults, or of all of them for core -1.
+    // Lock-free, so it can be read while the cores are faulting.
+    LatencySnapshot getFaultLatency(FaultStage stage, int coreId = -1) const;
+    void resetFaultLatency();
+    int numTlbs() const { return static_cast<int>(coreTlbs.size()); }
+    const CoreTlb& coreTlb(int coreId) const { return *coreTlbs[coreId]; }
 };
 
 extern DemandPagingAllocator demandPagingAllocator;
 
-void writePageToBackingStore(int processId, int pageNumber, const std::vector<int>& pageData);
-std::vector<int> readPageFromBackingStore(int processId, int pageNumber);
 bool readMemory(int processId, int virtualAddress, int& value);
 bool writeMemory(int processId, int virtualAddress, int value);
-void createProcessMemoryLayout(int pid, int memorySize);
+void createProcessMemoryLayout(int pid, int memorySize, bool announce = true);
 void displayPageTable(int pid);
 void displayMemorySegments(int pid);
 
@@ -0,0 +1,415 @@
+#include "page_replacement.h"
+#include <algorithm>
+#include <iostream>
+
+void FrameList::reset(int numFrames) {
+    prev.assign(numFrames, -1);
+    next.assign(numFrames, -1);
+    linked.assign(numFrames, false);
+    head = tail = -1;
+    count = 0;
+}
+
+void FrameList::pushFront(int frameNumber) {
+    prev[frameNumber] = -1;
+    next[frameNumber] = head;
+    if (head != -1) prev[head] = frameNumber;
+    head = frameNumber;
+    if (tail == -1) tail = frameNumber;
+    linked[frameNumber] = true;
+    count++;
+}
+
+void FrameList::remove(int frameNumber) {
+    if (!linked[frameNumber]) return;
+    if (prev[frameNumber] != -1) next[prev[frameNumber]] = next[frameNumber];
+    else head = next[frameNumber];
+    if (next[frameNumber] != -1) prev[next[frameNumber]] = prev[frameNumber];
+    else tail = prev[frameNumber];
+    prev[frameNumber] = next[frameNumber] = -1;
+    linked[frameNumber] = false;
+    count--;
+}
+
+void FrameList::moveToFront(int frameNumber) {
+    if (head == frameNumber) return;
+    remove(frameNumber);
+    pushFront(frameNumber);
+}
+
+void ResidentSets::reset(int numFrames) {
+    prev.assign(numFrames, -1);
+    next.assign(numFrames, -1);
+    byProcess.clear();
+}
+
+void ResidentSets::add(int processId, int frameNumber) {
+    ProcessFrames& frames = byProcess[processId];
+    prev[frameNumber] = -1;
+    next[frameNumber] = frames.head;
+    if (frames.head != -1) prev[frames.head] = frameNumber;
+    frames.head = frameNumber;
+    frames.count++;
+}
+
+void ResidentSets::remove(int processId, int frameNumber) {
+    auto it = byProcess.find(processId);
+    if (it == byProcess.end()) return;
+    ProcessFrames& frames = it->second;
+    if (prev[frameNumber] != -1) next[prev[frameNumber]] = next[frameNumber];
+    else frames.head = next[frameNumber];
+    if (next[frameNumber] != -1) prev[next[frameNumber]] = prev[frameNumber];
+    prev[frameNumber] = next[frameNumber] = -1;
+    if (--frames.count == 0) byProcess.erase(it);
+}
+
+std::vector<int> ResidentSets::take(int processId) {
+    std::vector<int> frames;
+    auto it = byProcess.find(processId);
+    if (it == byProcess.end()) return frames;
+    frames.reserve(it->second.count);
+    for (int frameNumber = it->second.head; frameNumber != -1;) {
+        int following = next[frameNumber];
+        prev[frameNumber] = next[frameNumber] = -1;
+        frames.push_back(frameNumber);
+        frameNumber = following;
+    }
+    byProcess.erase(it);
+    // Frame order keeps the free list, and so later placement, independent of load order
+    std::sort(frames.begin(), frames.end());
+    return frames;
+}
+
+std::vector<int> ResidentSets::frames(int processId) const {
+    std::vector<int> result;
+    auto it = byProcess.find(processId);
+    if (it == byProcess.end()) return result;
+    result.reserve(it->second.count);
+    for (int frameNumber = it->second.head; frameNumber != -1; frameNumber = next[frameNumber]) {
+        result.push_back(frameNumber);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+int ResidentSets::count(int processId) const {
+    auto it = byProcess.find(processId);
+    return it != byProcess.end() ? it->second.count : 0;
+}
+
+void GhostList::clear() {
+    order.clear();
+    index.clear();
+}
+
+void GhostList::pushFront(PageKey key) {
+    remove(key);
+    order.push_front(key);
+    index[key] = order.begin();
+}
+
+bool GhostList::remove(PageKey key) {
+    auto it = index.find(key);
+    if (it == index.end()) return false;
+    order.erase(it->second);
+    index.erase(it);
+    return true;
+}
+
+void GhostList::popBack() {
+    if (order.empty()) return;
+    index.erase(order.back());
+    order.pop_back();
+}
+
+// FIFO
+void FifoReplacement::reset(int numFrames) { loadOrder.reset(numFrames); }
+int FifoReplacement::selectVictim() { return loadOrder.back(); }
+void FifoReplacement::onLoad(int frameNumber, PageKey key) { loadOrder.pushFront(frameNumber); }
+void FifoReplacement::onEvict(int frameNumber) { loadOrder.remove(frameNumber); }
+void FifoReplacement::onFree(int frameNumber) { loadOrder.remove(frameNumber); }
+
+// LRU
+void LruReplacement::reset(int numFrames) { recency.reset(numFrames); }
+int LruReplacement::selectVictim() { return recency.back(); }
+void LruReplacement::onLoad(int frameNumber, PageKey key) { recency.pushFront(frameNumber); }
+void LruReplacement::onAccess(int frameNumber) { recency.moveToFront(frameNumber); }
+void LruReplacement::onEvict(int frameNumber) { recency.remove(frameNumber); }
+void LruReplacement::onFree(int frameNumber) { recency.remove(frameNumber); }
+
+// CLOCK
+void ClockReplacement::reset(int numFrames) {
+    occupied.assign(numFrames, false);
+    referenced.assign(numFrames, false);
+    hand = 0;
+}
+
+int ClockReplacement::selectVictim() {
+    int numFrames = static_cast<int>(occupied.size());
+    for (int step = 0; step <= 2 * numFrames; ++step) {
+        int candidate = hand;
+        hand = (hand + 1) % numFrames;
+        if (!occupied[candidate]) continue;
+        if (referenced[candidate]) {
+            referenced[candidate] = false;
+            continue;
+        }
+        return candidate;
+    }
+    return -1;
+}
+
+void ClockReplacement::onLoad(int frameNumber, PageKey key) {
+    occupied[frameNumber] = true;
+    referenced[frameNumber] = true;
+}
+
+void ClockReplacement::onAccess(int frameNumber) { referenced[frameNumber] = true; }
+
+void ClockReplacement::onEvict(int frameNumber) {
+    occupied[frameNumber] = false;
+    referenced[frameNumber] = false;
+}
+
+void ClockReplacement::onFree(int frameNumber) { onEvict(frameNumber); }
+
+// LFU
+void LfuReplacement::reset(int numFrames) {
+    frequency.assign(numFrames, 0);
+    lastUse.assign(numFrames, 0);
+    ranking.clear();
+    useCounter = 0;
+}
+
+void LfuReplacement::rerank(int frameNumber, int newFrequency) {
+    ranking.erase(std::make_tuple(frequency[frameNumber], lastUse[frameNumber], frameNumber));
+    frequency[frameNumber] = newFrequency;
+    lastUse[frameNumber] = ++useCounter;
+    ranking.insert(std::make_tuple(frequency[frameNumber], lastUse[frameNumber], frameNumber));
+}
+
+int LfuReplacement::selectVictim() {
+    if (ranking.empty()) return -1;
+    return std::get<2>(*ranking.begin());
+}
+
+void LfuReplacement::onLoad(int frameNumber, PageKey key) { rerank(frameNumber, 1); }
+void LfuReplacement::onAccess(int frameNumber) { rerank(frameNumber, frequency[frameNumber] + 1); }
+
+void LfuReplacement::onEvict(int frameNumber) {
+    ranking.erase(std::make_tuple(frequency[frameNumber], lastUse[frameNumber], frameNumber));
+    frequency[frameNumber] = 0;
+}
+
+void LfuReplacement::onFree(int frameNumber) { onEvict(frameNumber); }
+
+// ARC
+void ArcReplacement::reset(int numFrames) {
+    t1.reset(numFrames);
+    t2.reset(numFrames);
+    b1.clear();
+    b2.clear();
+    frameKeys.assign(numFrames, -1);
+    capacity = numFrames;
+    target = 0;
+    missInB2 = false;
+}
+
+void ArcReplacement::onMiss(PageKey key) {
+    missInB2 = false;
+    if (b1.contains(key)) {
+        target = std::min(capacity, target + std::max(1, b2.size() / std::max(1, b1.size())));
+    } else if (b2.contains(key)) {
+        target = std::max(0, target - std::max(1, b1.size() / std::max(1, b2.size())));
+        missInB2 = true;
+    }
+}
+
+int ArcReplacement::selectVictim() {
+    if (t1.size() > 0 && (t1.size() > target || (missInB2 && t1.size() == target))) return t1.back();
+    if (t2.size() > 0) return t2.back();
+    return t1.back();
+}
+
+void ArcReplacement::onLoad(int frameNumber, PageKey key) {
+    bool seenBefore = b1.remove(key) || b2.remove(key);
+    if (seenBefore) t2.pushFront(frameNumber);
+    else t1.pushFront(frameNumber);
+    frameKeys[frameNumber] = key;
+    missInB2 = false;
+
+    // Keep the directory at most 2c pages, with L1 = T1 + B1 at most c
+    while (t1.size() + b1.size() > capacity && b1.size() > 0) b1.popBack();
+    while (t1.size() + t2.size() + b1.size() + b2.size() > 2 * capacity && b2.size() > 0) b2.popBack();
+}
+
+void ArcReplacement::onAccess(int frameNumber) {
+    if (t1.contains(frameNumber)) {
+        t1.remove(frameNumber);
+        t2.pushFront(frameNumber);
+    } else {
+        t2.moveToFront(frameNumber);
+    }
+}
+
+void ArcReplacement::onEvict(int frameNumber) {
+    if (t1.contains(frameNumber)) {
+        t1.remove(frameNumber);
+        b1.pushFront(frameKeys[frameNumber]);
+    } else {
+        t2.remove(frameNumber);
+        b2.pushFront(frameKeys[frameNumber]);
+    }
+    frameKeys[frameNumber] = -1;
+}
+
+void ArcReplacement::onFree(int frameNumber) {
+    t1.remove(frameNumber);
+    t2.remove(frameNumber);
+    frameKeys[frameNumber] = -1;
+}
+
+// 2Q, with the paper's suggested sizes: A1in a quarter of memory, A1out
+// remembering half as many pages as there are frames.
+void TwoQueueReplacement::reset(int numFrames) {
+    a1in.reset(numFrames);
+    am.reset(numFrames);
+    a1out.clear();
+    frameKeys.assign(numFrames, -1);
+    inCapacity = std::max(1, numFrames / 4);
+    outCapacity = std::max(1, numFrames / 2);
+    missInA1out = false;
+}
+
+void TwoQueueReplacement::onMiss(PageKey key) { missInA1out = a1out.contains(key); }
+
+int TwoQueueReplacement::selectVictim() {
+    if (a1in.size() > 0 && (a1in.size() > inCapacity || am.size() == 0)) return a1in.back();
+    return am.back();
+}
+
+void TwoQueueReplacement::onLoad(int frameNumber, PageKey key) {
+    if (missInA1out) {
+        a1out.remove(key);
+        am.pushFront(frameNumber);
+    } else {
+        a1in.pushFront(frameNumber);
+    }
+    frameKeys[frameNumber] = key;
+    missInA1out = false;
+}
+
+void TwoQueueReplacement::onAccess(int frameNumber) {
+    if (am.contains(frameNumber)) am.moveToFront(frameNumber);
+}
+
+void TwoQueueReplacement::onEvict(int frameNumber) {
+    if (a1in.contains(frameNumber)) {
+        a1in.remove(frameNumber);
+        a1out.pushFront(frameKeys[frameNumber]);
+        while (a1out.size() > outCapacity) a1out.popBack();
+    } else {
+        am.remove(frameNumber);
+    }
+    frameKeys[frameNumber] = -1;
+}
+
+void TwoQueueReplacement::onFree(int frameNumber) {
+    a1in.remove(frameNumber);
+    am.remove(frameNumber);
+    frameKeys[frameNumber] = -1;
+}
+
+// OPT
+void BeladyReplacement::reset(int numFrames) {
+    frameNextUse.assign(numFrames, -1);
+    ranking.clear();
+}
+
+void BeladyReplacement::rerank(int frameNumber) {
+    if (frameNextUse[frameNumber] != -1) ranking.erase(std::make_pair(frameNextUse[frameNumber], frameNumber));
+    frameNextUse[frameNumber] = nextUse[cursor];
+    ranking.insert(std::make_pair(frameNextUse[frameNumber], frameNumber));
+}
+
+int BeladyReplacement::selectVictim() {
+    if (ranking.empty()) return -1;
+    return ranking.rbegin()->second;
+}
+
+void BeladyReplacement::onEvict(int frameNumber) {
+    if (frameNextUse[frameNumber] == -1) return;
+    ranking.erase(std::make_pair(frameNextUse[frameNumber], frameNumber));
+    frameNextUse[frameNumber] = -1;
+}
+
+std::unique_ptr<ReplacementPolicy> createReplacementPolicy(const std::string& name) {
+    if (name == "fifo") return std::unique_ptr<ReplacementPolicy>(new FifoReplacement());
+    if (name == "lru") return std::unique_ptr<ReplacementPolicy>(new LruReplacement());
+    if (name == "clock") return std::unique_ptr<ReplacementPolicy>(new ClockReplacement());
+    if (name == "lfu") return std::unique_ptr<ReplacementPolicy>(new LfuReplacement());
+    if (name == "arc") return std::unique_ptr<ReplacementPolicy>(new ArcReplacement());
+    if (name == "2q") return std::unique_ptr<ReplacementPolicy>(new TwoQueueReplacement());
+
+    std::cerr << "Warning: Unknown page-replacement '" << name << "'. Using clock.\n";
+    return std::unique_ptr<ReplacementPolicy>(new ClockReplacement());
+}
+
+const std::vector<std::string>& replacementPolicyNames() {
+    static const std::vector<std::string> names = {"fifo", "lru", "clock", "lfu", "arc", "2q"};
+    return names;
+}
+
+PageCacheSimulator::PageCacheSimulator(std::unique_ptr<ReplacementPolicy> replacementPolicy, int numFrames)
+    : policy(std::move(replacementPolicy)), frameKeys(numFrames, -1), dirty(numFrames, false) {
+    policy->reset(numFrames);
+    residentSets.reset(numFrames);
+    for (int i = 0; i < numFrames; ++i) freeFrames.push_back(i);
+}
+
+void PageCacheSimulator::access(int processId, int pageNumber, bool isWrite) {
+    stats.accesses++;
+    PageKey key = makePageKey(processId, pageNumber);
+
+    auto it = residentFrames.find(key);
+    if (it != residentFrames.end()) {
+        stats.hits++;
+        policy->onAccess(it->second);
+        if (isWrite) dirty[it->second] = true;
+        return;
+    }
+
+    stats.pageFaults++;
+    policy->onMiss(key);
+    int frameNumber;
+    if (!freeFrames.empty()) {
+        frameNumber = freeFrames.front();
+        freeFrames.pop_front();
+    } else {
+        frameNumber = policy->selectVictim();
+        if (frameNumber < 0) return;
+        if (dirty[frameNumber]) stats.dirtyWritebacks++;
+        residentFrames.erase(frameKeys[frameNumber]);
+        residentSets.remove(static_cast<int>(frameKeys[frameNumber] >> 32), frameNumber);
+        policy->onEvict(frameNumber);
+        stats.pageReplacements++;
+    }
+
+    residentFrames[key] = frameNumber;
+    residentSets.add(processId, frameNumber);
+    frameKeys[frameNumber] = key;
+    dirty[frameNumber] = isWrite;
+    policy->onLoad(frameNumber, key);
+    stats.framesUsed = static_cast<int>(frameKeys.size() - freeFrames.size());
+}
+
+void PageCacheSimulator::releaseProcess(int processId) {
+    for (int frameNumber : residentSets.take(processId)) {
+        residentFrames.erase(frameKeys[frameNumber]);
+        policy->onFree(frameNumber);
+        frameKeys[frameNumber] = -1;
+        dirty[frameNumber] = false;
+        freeFrames.push_back(frameNumber);
+    }
+    stats.framesUsed = static_cast<int>(frameKeys.size() - freeFrames.size());
+}
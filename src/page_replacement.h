@@ -0,0 +1,284 @@
+#ifndef PAGE_REPLACEMENT_H
+#define PAGE_REPLACEMENT_H
+
+#include <deque>
+#include <list>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Identifies a virtual page across processes: pid in the high half, page
+// number in the low half.
+using PageKey = long long;
+
+inline PageKey makePageKey(int processId, int pageNumber) {
+    return (static_cast<PageKey>(processId) << 32) | static_cast<unsigned int>(pageNumber);
+}
+
+// Decides which resident frame to give up when memory is full. Policies only
+// see frame numbers and page keys; the pager owns the frames and their data.
+// Every call happens with the pager's frame lock held.
+class ReplacementPolicy {
+public:
+    virtual ~ReplacementPolicy() = default;
+    virtual std::string name() const = 0;
+
+    virtual void reset(int numFrames) = 0;
+
+    // A fault on key is about to be served, before any victim is chosen.
+    virtual void onMiss(PageKey key) {}
+    // Only called when every frame is occupied.
+    virtual int selectVictim() = 0;
+    virtual void onLoad(int frameNumber, PageKey key) = 0;
+    virtual void onAccess(int frameNumber) = 0;
+    // The frame's page was replaced; adaptive policies may remember it.
+    virtual void onEvict(int frameNumber) = 0;
+    // The frame's owner exited; the page will never be asked for again.
+    virtual void onFree(int frameNumber) = 0;
+};
+
+// Doubly-linked list of frame numbers kept in flat arrays, so linking,
+// unlinking and moving a frame are O(1) and never allocate.
+class FrameList {
+private:
+    std::vector<int> prev;
+    std::vector<int> next;
+    std::vector<bool> linked;
+    int head;
+    int tail;
+    int count;
+
+public:
+    FrameList() : head(-1), tail(-1), count(0) {}
+    void reset(int numFrames);
+    void pushFront(int frameNumber);
+    void remove(int frameNumber);
+    void moveToFront(int frameNumber);
+    bool contains(int frameNumber) const { return linked[frameNumber]; }
+    int back() const { return tail; }
+    int size() const { return count; }
+};
+
+// Page keys of recently evicted pages in LRU order, with O(1) lookup.
+class GhostList {
+private:
+    std::list<PageKey> order;
+    std::unordered_map<PageKey, std::list<PageKey>::iterator> index;
+
+public:
+    void clear();
+    void pushFront(PageKey key);
+    bool remove(PageKey key);
+    void popBack();
+    bool contains(PageKey key) const { return index.count(key) != 0; }
+    int size() const { return static_cast<int>(index.size()); }
+};
+
+// The frames each process holds, as one intrusive list per process over
+// shared prev/next arrays. Adding, removing and releasing a whole process
+// cost time proportional to that process's resident set.
+class ResidentSets {
+private:
+    struct ProcessFrames {
+        int head = -1;
+        int count = 0;
+    };
+
+    std::vector<int> prev;
+    std::vector<int> next;
+    std::unordered_map<int, ProcessFrames> byProcess;
+
+public:
+    void reset(int numFrames);
+    void add(int processId, int frameNumber);
+    void remove(int processId, int frameNumber);
+    // Unlinks every frame of the process and returns them in frame order.
+    std::vector<int> take(int processId);
+    // The process's frames in frame order, left linked.
+    std::vector<int> frames(int processId) const;
+    int count(int processId) const;
+};
+
+class FifoReplacement : public ReplacementPolicy {
+private:
+    FrameList loadOrder;
+
+public:
+    std::string name() const override { return "fifo"; }
+    void reset(int numFrames) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override {}
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+class LruReplacement : public ReplacementPolicy {
+private:
+    FrameList recency;
+
+public:
+    std::string name() const override { return "lru"; }
+    void reset(int numFrames) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override;
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+// Second chance: the hand skips, and clears, frames referenced since it
+// last passed them.
+class ClockReplacement : public ReplacementPolicy {
+private:
+    std::vector<bool> occupied;
+    std::vector<bool> referenced;
+    int hand;
+
+public:
+    ClockReplacement() : hand(0) {}
+    std::string name() const override { return "clock"; }
+    void reset(int numFrames) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override;
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+// Least frequently used, ties broken by least recent use.
+class LfuReplacement : public ReplacementPolicy {
+private:
+    std::vector<int> frequency;
+    std::vector<unsigned long long> lastUse;
+    std::set<std::tuple<int, unsigned long long, int>> ranking;
+    unsigned long long useCounter;
+
+    void rerank(int frameNumber, int newFrequency);
+
+public:
+    LfuReplacement() : useCounter(0) {}
+    std::string name() const override { return "lfu"; }
+    void reset(int numFrames) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override;
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha). T1 holds pages seen once,
+// T2 pages seen at least twice, B1/B2 remember what each recently evicted.
+// Target p moves toward whichever ghost list keeps getting hit.
+class ArcReplacement : public ReplacementPolicy {
+private:
+    FrameList t1;
+    FrameList t2;
+    GhostList b1;
+    GhostList b2;
+    std::vector<PageKey> frameKeys;
+    int capacity;
+    int target;
+    bool missInB2;
+
+public:
+    ArcReplacement() : capacity(0), target(0), missInB2(false) {}
+    std::string name() const override { return "arc"; }
+    void reset(int numFrames) override;
+    void onMiss(PageKey key) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override;
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+// Full 2Q (Johnson & Shasha). New pages enter the A1in FIFO; pages faulted
+// again while remembered in A1out are promoted to the Am LRU list.
+class TwoQueueReplacement : public ReplacementPolicy {
+private:
+    FrameList a1in;
+    FrameList am;
+    GhostList a1out;
+    std::vector<PageKey> frameKeys;
+    int inCapacity;
+    int outCapacity;
+    bool missInA1out;
+
+public:
+    TwoQueueReplacement() : inCapacity(0), outCapacity(0), missInA1out(false) {}
+    std::string name() const override { return "2q"; }
+    void reset(int numFrames) override;
+    void onMiss(PageKey key) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override;
+    void onAccess(int frameNumber) override;
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override;
+};
+
+// Belady's optimal policy: evicts the page whose next use lies furthest in
+// the future. It needs the whole access sequence up front, so it only runs
+// offline against a recorded trace. nextUse[i] is the index of the next
+// access to the page touched by access i; the driver moves the cursor to
+// the current access before each one.
+class BeladyReplacement : public ReplacementPolicy {
+private:
+    const std::vector<long long>& nextUse;
+    long long cursor;
+    std::vector<long long> frameNextUse;
+    std::set<std::pair<long long, int>> ranking;
+
+    void rerank(int frameNumber);
+
+public:
+    explicit BeladyReplacement(const std::vector<long long>& nextUseIndex)
+        : nextUse(nextUseIndex), cursor(0) {}
+    std::string name() const override { return "opt"; }
+    void setCursor(long long index) { cursor = index; }
+    void reset(int numFrames) override;
+    int selectVictim() override;
+    void onLoad(int frameNumber, PageKey key) override { rerank(frameNumber); }
+    void onAccess(int frameNumber) override { rerank(frameNumber); }
+    void onEvict(int frameNumber) override;
+    void onFree(int frameNumber) override { onEvict(frameNumber); }
+};
+
+std::unique_ptr<ReplacementPolicy> createReplacementPolicy(const std::string& name);
+const std::vector<std::string>& replacementPolicyNames();
+
+struct PagingStatistics {
+    long long accesses = 0;
+    long long hits = 0;
+    long long pageFaults = 0;
+    long long pageReplacements = 0;
+    long long dirtyWritebacks = 0;
+    int framesUsed = 0;
+
+    double hitRatio() const { return accesses > 0 ? static_cast<double>(hits) / accesses : 0.0; }
+};
+
+// Resident-set model of the pager without page contents. Replays page
+// accesses through a policy and counts what the real pager would have done.
+class PageCacheSimulator {
+private:
+    std::unique_ptr<ReplacementPolicy> policy;
+    std::unordered_map<PageKey, int> residentFrames;
+    std::vector<PageKey> frameKeys;
+    std::vector<bool> dirty;
+    std::deque<int> freeFrames;   // handed out in the same order as the pager's free list
+    ResidentSets residentSets;
+    PagingStatistics stats;
+
+public:
+    PageCacheSimulator(std::unique_ptr<ReplacementPolicy> replacementPolicy, int numFrames);
+    void access(int processId, int pageNumber, bool isWrite);
+    void releaseProcess(int processId);
+    std::string name() const { return policy->name(); }
+    const PagingStatistics& statistics() const { return stats; }
+};
+
+#endif // PAGE_REPLACEMENT_H
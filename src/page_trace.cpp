@@ -0,0 +1,114 @@
+#include "page_trace.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+PageTraceRecorder pageTraceRecorder;
+
+static const char TRACE_MAGIC[4] = {'C', 'S', 'P', 'T'};
+static const size_t RECORD_SIZE = 12;
+static const size_t FLUSH_THRESHOLD = 64 * 1024;
+
+static void putWord(std::vector<char>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+}
+
+static uint32_t getWord(const unsigned char* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+PageTraceRecorder::PageTraceRecorder() : recording(false), recordCount(0) {}
+
+bool PageTraceRecorder::start(const std::string& path, int pageSize, int numFrames) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (recording) return false;
+
+    file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Error: Cannot open trace file " << path << "\n";
+        return false;
+    }
+
+    buffer.clear();
+    buffer.reserve(FLUSH_THRESHOLD + RECORD_SIZE);
+    for (char c : TRACE_MAGIC) buffer.push_back(c);
+    putWord(buffer, TraceHeader().version);
+    putWord(buffer, static_cast<uint32_t>(pageSize));
+    putWord(buffer, static_cast<uint32_t>(numFrames));
+    recordCount = 0;
+    recording = true;
+    return true;
+}
+
+long long PageTraceRecorder::stop() {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!recording) return 0;
+    recording = false;
+    flushLocked();
+    file.close();
+    return recordCount;
+}
+
+void PageTraceRecorder::flushLocked() {
+    if (!buffer.empty()) file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void PageTraceRecorder::append(uint32_t processId, uint32_t tick, uint32_t addressAndFlags) {
+    std::lock_guard<std::mutex> lock(traceMutex);
+    if (!recording) return;
+    putWord(buffer, processId);
+    putWord(buffer, tick);
+    putWord(buffer, addressAndFlags);
+    recordCount++;
+    if (buffer.size() >= FLUSH_THRESHOLD) flushLocked();
+}
+
+void PageTraceRecorder::recordAccess(int processId, int virtualAddress, bool isWrite, unsigned long long tick) {
+    if (!active()) return;
+    uint32_t word = static_cast<uint32_t>(virtualAddress) & TraceRecord::ADDRESS_MASK;
+    if (isWrite) word |= TraceRecord::WRITE_FLAG;
+    append(static_cast<uint32_t>(processId), static_cast<uint32_t>(tick), word);
+}
+
+void PageTraceRecorder::recordExit(int processId, unsigned long long tick) {
+    if (!active()) return;
+    append(static_cast<uint32_t>(processId), static_cast<uint32_t>(tick), TraceRecord::EXIT_FLAG);
+}
+
+bool readPageTrace(const std::string& path, TraceHeader& header, std::vector<TraceRecord>& records) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Cannot open trace file " << path << "\n";
+        return false;
+    }
+
+    unsigned char head[16];
+    if (!file.read(reinterpret_cast<char*>(head), sizeof(head)) ||
+        !std::equal(TRACE_MAGIC, TRACE_MAGIC + 4, reinterpret_cast<const char*>(head))) {
+        std::cerr << "Error: " << path << " is not a page trace\n";
+        return false;
+    }
+    header.version = getWord(head + 4);
+    header.pageSize = static_cast<int>(getWord(head + 8));
+    header.numFrames = static_cast<int>(getWord(head + 12));
+    if (header.version != TraceHeader().version || header.pageSize <= 0) {
+        std::cerr << "Error: Unsupported trace version " << header.version << "\n";
+        return false;
+    }
+
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t count = data.size() / RECORD_SIZE;
+    records.clear();
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const unsigned char* in = data.data() + i * RECORD_SIZE;
+        TraceRecord record;
+        record.processId = getWord(in);
+        record.tick = getWord(in + 4);
+        record.addressAndFlags = getWord(in + 8);
+        records.push_back(record);
+    }
+    return true;
+}
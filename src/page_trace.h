@@ -0,0 +1,61 @@
+#ifndef PAGE_TRACE_H
+#define PAGE_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Binary page-access trace. The file starts with a 16-byte header
+// ("CSPT", version, page size, frame count) followed by 12-byte records:
+// pid, tick and a word holding the virtual address in the low 30 bits
+// plus write and process-exit flags. All fields are little-endian.
+struct TraceRecord {
+    static const uint32_t WRITE_FLAG = 1u << 31;
+    static const uint32_t EXIT_FLAG = 1u << 30;
+    static const uint32_t ADDRESS_MASK = EXIT_FLAG - 1;
+
+    uint32_t processId = 0;
+    uint32_t tick = 0;
+    uint32_t addressAndFlags = 0;
+
+    int address() const { return static_cast<int>(addressAndFlags & ADDRESS_MASK); }
+    bool isWrite() const { return (addressAndFlags & WRITE_FLAG) != 0; }
+    bool isExit() const { return (addressAndFlags & EXIT_FLAG) != 0; }
+};
+
+struct TraceHeader {
+    uint32_t version = 1;
+    int pageSize = 0;
+    int numFrames = 0;
+};
+
+// Appends pager events to a trace file while recording is on. Records are
+// buffered and written in large blocks so tracing stays cheap.
+class PageTraceRecorder {
+private:
+    std::ofstream file;
+    std::vector<char> buffer;
+    std::mutex traceMutex;
+    std::atomic<bool> recording;
+    long long recordCount;
+
+    void append(uint32_t processId, uint32_t tick, uint32_t addressAndFlags);
+    void flushLocked();
+
+public:
+    PageTraceRecorder();
+    bool start(const std::string& path, int pageSize, int numFrames);
+    long long stop();
+    bool active() const { return recording.load(std::memory_order_relaxed); }
+    void recordAccess(int processId, int virtualAddress, bool isWrite, unsigned long long tick);
+    void recordExit(int processId, unsigned long long tick);
+};
+
+extern PageTraceRecorder pageTraceRecorder;
+
+bool readPageTrace(const std::string& path, TraceHeader& header, std::vector<TraceRecord>& records);
+
+#endif // PAGE_TRACE_H
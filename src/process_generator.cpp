@@ -0,0 +1,145 @@
+#include "process_generator.h"
+#include "scheduler.h"
+#include "globals.h"
+#include "config.h"
+#include "memory_manager.h"
+#include "bytecode.h"
+#include "sim_clock.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+static const int GENERATED_VARIABLE_POOL = 8;
+
+static std::string variableName(int index) {
+    return "var" + std::to_string(index);
+}
+
+static std::string hexAddress(int address) {
+    std::ostringstream oss;
+    oss << "0x" << std::uppercase << std::hex << address;
+    return oss.str();
+}
+
+std::vector<Instruction> generateRandomProgram(std::mt19937& rng, int length, int memorySize) {
+    std::vector<Instruction> program;
+    std::vector<int> declared;
+    std::uniform_int_distribution<int> typeDist(0, 7);
+    std::uniform_int_distribution<int> varDist(0, GENERATED_VARIABLE_POOL - 1);
+    std::uniform_int_distribution<int> valueDist(0, 100);
+    std::uniform_int_distribution<int> divisorDist(1, 9);
+
+    // Data accesses stay word-aligned and clear of the symbol table
+    int dataWords = (memorySize - SYMBOL_TABLE_SIZE) / static_cast<int>(sizeof(int));
+    std::uniform_int_distribution<int> wordDist(0, std::max(0, dataWords - 1));
+
+    auto pickDeclared = [&]() { return variableName(declared[rng() % declared.size()]); };
+    auto pickOperand = [&]() {
+        return (rng() % 2 == 0) ? pickDeclared() : std::to_string(valueDist(rng));
+    };
+    auto markDeclared = [&](int index) {
+        if (std::find(declared.begin(), declared.end(), index) == declared.end()) {
+            declared.push_back(index);
+        }
+    };
+
+    program.reserve(length);
+    program.emplace_back(InstructionType::DECLARE,
+                         std::vector<std::string>{variableName(0), std::to_string(valueDist(rng))});
+    markDeclared(0);
+
+    while (static_cast<int>(program.size()) < length) {
+        int target = varDist(rng);
+        InstructionType type = static_cast<InstructionType>(typeDist(rng));
+
+        if ((type == InstructionType::READ || type == InstructionType::WRITE) && dataWords <= 0) {
+            type = InstructionType::PRINT;
+        }
+
+        switch (type) {
+            case InstructionType::DECLARE:
+                program.emplace_back(type, std::vector<std::string>{variableName(target),
+                                                                    std::to_string(valueDist(rng))});
+                markDeclared(target);
+                break;
+            case InstructionType::ADD:
+            case InstructionType::SUB:
+            case InstructionType::MUL:
+                program.emplace_back(type, std::vector<std::string>{variableName(target),
+                                                                    pickOperand(), pickOperand()});
+                markDeclared(target);
+                break;
+            case InstructionType::DIV:
+                program.emplace_back(type, std::vector<std::string>{variableName(target), pickOperand(),
+                                                                    std::to_string(divisorDist(rng))});
+                markDeclared(target);
+                break;
+            case InstructionType::WRITE:
+                program.emplace_back(type, std::vector<std::string>{
+                    hexAddress(SYMBOL_TABLE_SIZE + wordDist(rng) * static_cast<int>(sizeof(int))), pickDeclared()});
+                break;
+            case InstructionType::READ:
+                program.emplace_back(type, std::vector<std::string>{
+                    variableName(target), hexAddress(SYMBOL_TABLE_SIZE + wordDist(rng) * static_cast<int>(sizeof(int)))});
+                markDeclared(target);
+                break;
+            case InstructionType::PRINT: {
+                std::string var = pickDeclared();
+                program.emplace_back(type, std::vector<std::string>{"\"Value of " + var + ": \" + " + var});
+                break;
+            }
+        }
+    }
+    return program;
+}
+
+// Random power of two between min-mem-per-proc and max-mem-per-proc.
+int randomProcessMemorySize(std::mt19937& rng) {
+    int low = std::max(64, config.min_mem_per_proc);
+    int high = std::max(low, config.max_mem_per_proc);
+    std::vector<int> sizes;
+    for (int size = 64; size <= high && size > 0; size *= 2) {
+        if (size >= low) sizes.push_back(size);
+    }
+    if (sizes.empty()) return low;
+    return sizes[rng() % sizes.size()];
+}
+
+void processGeneratorThread() {
+    std::mt19937 rng(std::random_device{}());
+    int minIns = std::max(1, config.min_ins);
+    int maxIns = std::max(minIns, config.max_ins);
+    std::uniform_int_distribution<int> lengthDist(minIns, maxIns);
+    std::uniform_int_distribution<int> priorityDist(0, 4);
+
+    while (!stopScheduler) {
+        int memorySize = randomProcessMemorySize(rng);
+        std::shared_ptr<Program> program = std::make_shared<Program>();
+        if (!compileProgram(generateRandomProgram(rng, lengthDist(rng), memorySize), memorySize, *program)) {
+            // Skip this arrival rather than submit a half-built program
+            std::cerr << "Error: Failed to compile a generated program; skipping this arrival.\n";
+            simClock.awaitTicks(std::max(1, config.batch_process_freq));
+            continue;
+        }
+        int pid = nextPid++;
+        {
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            Session s;
+            s.start = Clock::now();
+            s.finished = false;
+            s.memorySize = memorySize;
+            s.priority = priorityDist(rng);
+            s.program = program;
+            sessions[pid] = std::move(s);
+            processNames[pid] = std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid);
+
+            createProcessMemoryLayout(pid, memorySize, false);
+        }
+        submitProcess(pid);
+
+        simClock.awaitTicks(std::max(1, config.batch_process_freq));
+    }
+
+    generatorRunning = false;
+    simClock.detach();
+}
@@ -0,0 +1,12 @@
+#ifndef PROCESS_GENERATOR_H
+#define PROCESS_GENERATOR_H
+
+#include "structures.h"
+#include <vector>
+#include <random>
+
+std::vector<Instruction> generateRandomProgram(std::mt19937& rng, int length, int memorySize);
+int randomProcessMemorySize(std::mt19937& rng);
+void processGeneratorThread();
+
+#endif // PROCESS_GENERATOR_H
@@ -2,13 +2,33 @@
 #include "globals.h"
 #include "config.h"
 #include "utils.h"
+#include "sim_clock.h"
+#include "contiguous_allocator.h"
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 
 auto lastSnapshotTime = Clock::now();
 const int SNAPSHOT_INTERVAL_SECONDS = 1;
 
+// The live allocator's layout and figures; with no memory-allocator set,
+// memory is one free block. Called with memoryMutex held.
+static std::vector<MemoryBlock> currentBlocks() {
+    if (contiguousAllocator) return contiguousAllocator->blocks();
+    return {{0, config.max_memory_size - 1, -1}};
+}
+
+static ContiguousStatistics currentStatistics() {
+    if (contiguousAllocator) return contiguousAllocator->statistics();
+    ContiguousStatistics stats;
+    stats.totalBytes = config.max_memory_size;
+    stats.freeBytes = config.max_memory_size;
+    stats.largestFreeBlock = config.max_memory_size;
+    stats.freeBlocks = 1;
+    return stats;
+}
+
 void snapshotMemory() {
     auto now = Clock::now();
     auto timeSinceLastSnapshot = std::chrono::duration_cast<std::chrono::seconds>(now - lastSnapshotTime);
@@ -28,20 +48,15 @@ void snapshotMemory() {
     strftime(buffer, sizeof(buffer), "%m/%d/%Y %I:%M:%S%p", &tm);
     ofs << "Timestamp: (" << buffer << ")\n";
 
-    int procCount = 0;
-    int externalFrag = 0;
-    for (const auto& block : memoryBlocks) {
-        if (block.pid != -1) ++procCount;
-        else if ((block.end - block.start + 1) < config.mem_per_proc)
-            externalFrag += (block.end - block.start + 1);
-    }
+    ContiguousStatistics stats = currentStatistics();
+    std::vector<MemoryBlock> blocks = currentBlocks();
 
-    ofs << "Number of processes in memory: " << procCount << "\n";
-    ofs << "Total external fragmentation in KB: " << externalFrag / 1024 << "\n\n";
+    ofs << "Number of processes in memory: " << stats.processes << "\n";
+    ofs << "Total external fragmentation in KB: " << stats.externalFragmentation() / 1024 << "\n\n";
 
-    ofs << "----end---- = " << config.max_overall_mem << "\n\n";
+    ofs << "----end---- = " << config.max_memory_size << "\n\n";
 
-    for (auto it = memoryBlocks.rbegin(); it != memoryBlocks.rend(); ++it) {
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
         const auto& block = *it;
         if (block.pid != -1) {
             ofs << block.end << "\n";
@@ -74,37 +89,28 @@ void generateMemoryReport() {
     ofs << "||======================================||\n\n";
     ofs << "Generated: " << buffer << "\n\n";
 
-    int totalMemory = config.max_overall_mem;
-    int usedMemory = 0;
-    int freeMemory = 0;
-    int externalFrag = 0;
-    int processCount = 0;
-
-    for (const auto& block : memoryBlocks) {
-        if (block.pid != -1) {
-            usedMemory += (block.end - block.start + 1);
-            processCount++;
-        } else {
-            int blockSize = block.end - block.start + 1;
-            freeMemory += blockSize;
-            if (blockSize < config.mem_per_proc) {
-                externalFrag += blockSize;
-            }
-        }
-    }
+    ContiguousStatistics stats = currentStatistics();
+    std::vector<MemoryBlock> blocks = currentBlocks();
 
     ofs << "MEMORY STATISTICS:\n";
-    ofs << "  Total Memory: " << totalMemory << " bytes (" << totalMemory/1024 << " KB)\n";
-    ofs << "  Used Memory: " << usedMemory << " bytes (" << usedMemory/1024 << " KB)\n";
-    ofs << "  Free Memory: " << freeMemory << " bytes (" << freeMemory/1024 << " KB)\n";
-    ofs << "  Memory Utilization: " << (usedMemory * 100 / totalMemory) << "%\n";
-    ofs << "  External Fragmentation: " << externalFrag << " bytes (" << externalFrag/1024 << " KB)\n";
-    ofs << "  Number of Processes: " << processCount << "\n\n";
+    ofs << "  Allocator: " << config.memory_allocator << "\n";
+    ofs << "  Total Memory: " << stats.totalBytes << " bytes (" << stats.totalBytes/1024 << " KB)\n";
+    ofs << "  Used Memory: " << stats.heldBytes << " bytes (" << stats.heldBytes/1024 << " KB)\n";
+    ofs << "  Free Memory: " << stats.freeBytes << " bytes (" << stats.freeBytes/1024 << " KB)\n";
+    ofs << "  Memory Utilization: " << static_cast<int>(stats.utilization() * 100) << "%\n";
+    ofs << "  Largest Free Block: " << stats.largestFreeBlock << " bytes in " << stats.freeBlocks << " free blocks\n";
+    ofs << "  External Fragmentation: " << stats.externalFragmentation() << " bytes ("
+        << stats.externalFragmentation()/1024 << " KB)\n";
+    ofs << "  Internal Fragmentation: " << stats.internalFragmentation() << " bytes ("
+        << stats.internalFragmentation()/1024 << " KB)\n";
+    ofs << "  Deferred Placements: " << stats.failedAllocations << "\n";
+    ofs << "  Number of Processes: " << stats.processes << "\n\n";
 
     ofs << "PROCESS DETAILS:\n";
     ofs << "PID | Process Name     | Memory (bytes) | Pages | Status\n";
     ofs << "----|------------------|----------------|-------|--------\n";
     
+    std::lock_guard<std::mutex> sessionLock(sessionMutex);
     for (const auto& session : sessions) {
         int pid = session.first;
         const auto& s = session.second;
@@ -122,7 +128,7 @@ void generateMemoryReport() {
     ofs << "\nMEMORY LAYOUT:\n";
     ofs << "----end---- = " << config.max_memory_size << "\n\n";
 
-    for (auto it = memoryBlocks.rbegin(); it != memoryBlocks.rend(); ++it) {
+    for (auto it = blocks.rbegin(); it != blocks.rend(); ++it) {
         const auto& block = *it;
         if (block.pid != -1) {
             ofs << block.end << "\n";
@@ -144,6 +150,38 @@ void generateMemoryReport() {
     std::cout << "Memory report generated: memory_report.txt\n";
 }
 
+void writeSchedulingSummary(std::ostream& out) {
+    long long finished = 0;
+    long long totalTurnaround = 0;
+    long long totalWaiting = 0;
+    long long totalResponse = 0;
+    long long lastCompletion = 0;
+
+    for (const auto& entry : sessions) {
+        const Session& s = entry.second;
+        if (!s.finished || s.completionTick < 0) continue;
+        long long turnaround = s.completionTick - s.arrivalTick;
+        finished++;
+        totalTurnaround += turnaround;
+        totalWaiting += std::max(0LL, turnaround - s.cpu_active_ticks);
+        totalResponse += std::max(0LL, s.firstRunTick - s.arrivalTick);
+        lastCompletion = std::max(lastCompletion, s.completionTick);
+    }
+
+    out << "Scheduler: " << config.scheduler << " (tick " << simClock.now() << ")\n";
+    out << "Finished processes: " << finished << "\n";
+    if (finished == 0) return;
+
+    out << std::fixed << std::setprecision(2);
+    out << "Throughput: " << (lastCompletion > 0 ? finished * 1000.0 / lastCompletion : 0.0)
+        << " processes per 1000 ticks\n";
+    out << "Avg turnaround: " << static_cast<double>(totalTurnaround) / finished << " ticks\n";
+    out << "Avg waiting: " << static_cast<double>(totalWaiting) / finished << " ticks\n";
+    out << "Avg response: " << static_cast<double>(totalResponse) / finished << " ticks\n";
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
+
 void generateUtilizationReport() {
     std::ofstream ofs("csopesy-log.txt");
 
@@ -156,6 +194,8 @@ void generateUtilizationReport() {
         << "||         CSOPESY CPU UTIL REPORT      ||\n"
         << "||======================================||\n\n";
 
+    // Sessions and names are still being added by the generator thread
+    std::lock_guard<std::mutex> lock(sessionMutex);
     int coresUsed = config.num_cpu;
     int running = 0, finished = 0;
     for (const auto& entry : sessions) {
@@ -168,6 +208,8 @@ void generateUtilizationReport() {
     ofs << "Cores available: " << 0 << "\n\n";
     ofs << "Total CPU Active Ticks: " << total_cpu_active_ticks << "\n";
     ofs << "Total CPU Idle Ticks: " << total_cpu_idle_ticks << "\n\n";
+    writeSchedulingSummary(ofs);
+    ofs << "\n";
     ofs << "------------------------------------------\n";
     ofs << "Running processes:\n";
     for (const auto& entry : sessions) {
@@ -177,7 +219,7 @@ void generateUtilizationReport() {
             std::string name = processNames[pid];
             int pages = s.memoryLayout ? s.memoryLayout->pageTable.numPages : 0;
             ofs << name << "  (" << formatTimestamp(s.start) << ")"
-                << "   Core: " << (pid - 1) % config.num_cpu
+                << "   Core: " << (s.lastCore >= 0 ? std::to_string(s.lastCore) : "-")
                 << "   Active Ticks: " << s.cpu_active_ticks
                 << "   Idle Ticks: " << s.cpu_idle_ticks
                 << "   [" << s.memorySize << " bytes, " << pages << " pages]" << "\n";
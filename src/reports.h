@@ -1,8 +1,11 @@
 #ifndef REPORTS_H
 #define REPORTS_H
 
+#include <ostream>
+
 void snapshotMemory();
 void generateMemoryReport();
 void generateUtilizationReport();
+void writeSchedulingSummary(std::ostream& out);
 
 #endif // REPORTS_H
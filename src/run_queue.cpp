@@ -0,0 +1,122 @@
+#include "run_queue.h"
+#include <iterator>
+
+WorkStealingRunQueues runQueues;
+
+CoreRunQueue::CoreRunQueue() : depth(0) {}
+
+void CoreRunQueue::push(const ReadyKey& key, int pid) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    tasks.insert(std::make_pair(key, pid));
+    depth.store(static_cast<int>(tasks.size()), std::memory_order_relaxed);
+}
+
+bool CoreRunQueue::pop(int& pid) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (tasks.empty()) return false;
+    pid = tasks.begin()->second;
+    tasks.erase(tasks.begin());
+    depth.store(static_cast<int>(tasks.size()), std::memory_order_relaxed);
+    return true;
+}
+
+bool CoreRunQueue::steal(int& pid) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (tasks.empty()) return false;
+    auto last = std::prev(tasks.end());
+    pid = last->second;
+    tasks.erase(last);
+    depth.store(static_cast<int>(tasks.size()), std::memory_order_relaxed);
+    return true;
+}
+
+void CoreRunQueue::clear() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    tasks.clear();
+    depth.store(0, std::memory_order_relaxed);
+}
+
+CoreQueueStats::CoreQueueStats()
+    : dispatched(0), steals(0), stolenFrom(0), failedSteals(0), idleTicks(0) {}
+
+void CoreQueueStats::reset() {
+    dispatched = 0;
+    steals = 0;
+    stolenFrom = 0;
+    failedSteals = 0;
+    idleTicks = 0;
+}
+
+WorkStealingRunQueues::WorkStealingRunQueues() : queuedCount(0), outstanding(0) {}
+
+void WorkStealingRunQueues::init(int numCores) {
+    queues.clear();
+    stats.clear();
+    for (int i = 0; i < numCores; ++i) {
+        queues.emplace_back(new CoreRunQueue());
+        stats.emplace_back(new CoreQueueStats());
+    }
+    queuedCount = 0;
+    outstanding = 0;
+}
+
+// New process entering the system; it stays outstanding until complete().
+void WorkStealingRunQueues::submit(int coreId, int pid, const ReadyKey& key) {
+    outstanding++;
+    requeue(coreId, pid, key);
+}
+
+// Process that already counts as outstanding, e.g. after its quantum expired.
+void WorkStealingRunQueues::requeue(int coreId, int pid, const ReadyKey& key) {
+    queues[coreId]->push(key, pid);
+    queuedCount++;
+}
+
+void WorkStealingRunQueues::complete() {
+    outstanding--;
+}
+
+bool WorkStealingRunQueues::stealFor(int coreId, int& pid) {
+    int n = numCores();
+
+    // Pick the most loaded victim so a single steal does the most balancing.
+    int victim = -1;
+    int deepest = 0;
+    for (int offset = 1; offset < n; ++offset) {
+        int candidate = (coreId + offset) % n;
+        int depthNow = queues[candidate]->size();
+        if (depthNow > deepest) {
+            deepest = depthNow;
+            victim = candidate;
+        }
+    }
+    if (victim == -1) return false;
+
+    if (!queues[victim]->steal(pid)) {
+        stats[coreId]->failedSteals++;
+        return false;
+    }
+    stats[coreId]->steals++;
+    stats[victim]->stolenFrom++;
+    return true;
+}
+
+bool WorkStealingRunQueues::acquire(int coreId, int& pid) {
+    if (queues[coreId]->pop(pid) || stealFor(coreId, pid)) {
+        queuedCount--;
+        stats[coreId]->dispatched++;
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingRunQueues::recordIdle(int coreId) {
+    stats[coreId]->idleTicks++;
+}
+
+void WorkStealingRunQueues::clear() {
+    for (auto& queue : queues) queue->clear();
+    for (auto& coreStat : stats) coreStat->reset();
+    queuedCount = 0;
+    outstanding = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef RUN_QUEUE_H
+#define RUN_QUEUE_H
+
+#include <set>
+#include <utility>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+// (rank, enqueue sequence): the policy's rank orders processes and the
+// sequence keeps equal ranks in FIFO order, so neither has to fit in the other's bits.
+typedef std::pair<long long, long long> ReadyKey;
+
+// Ready queue owned by a single core, ordered by the scheduling policy's key.
+// The owner takes the lowest key from the front while idle cores steal the
+// highest key from the back, keeping owner and thieves on opposite ends.
+class CoreRunQueue {
+private:
+    std::set<std::pair<ReadyKey, int>> tasks;
+    std::mutex queueMutex;
+    std::atomic<int> depth;
+
+public:
+    CoreRunQueue();
+    void push(const ReadyKey& key, int pid);
+    bool pop(int& pid);
+    bool steal(int& pid);
+    int size() const { return depth.load(std::memory_order_relaxed); }
+    void clear();
+};
+
+struct CoreQueueStats {
+    std::atomic<long long> dispatched;
+    std::atomic<long long> steals;
+    std::atomic<long long> stolenFrom;
+    std::atomic<long long> failedSteals;
+    std::atomic<long long> idleTicks;
+
+    CoreQueueStats();
+    void reset();
+};
+
+class WorkStealingRunQueues {
+private:
+    std::vector<std::unique_ptr<CoreRunQueue>> queues;
+    std::vector<std::unique_ptr<CoreQueueStats>> stats;
+    std::atomic<int> queuedCount;
+    std::atomic<int> outstanding;
+
+    bool stealFor(int coreId, int& pid);
+
+public:
+    WorkStealingRunQueues();
+    void init(int numCores);
+    void submit(int coreId, int pid, const ReadyKey& key);
+    void requeue(int coreId, int pid, const ReadyKey& key);
+    void complete();
+    bool acquire(int coreId, int& pid);
+    void recordIdle(int coreId);
+    void clear();
+
+    int numCores() const { return static_cast<int>(queues.size()); }
+    int totalQueued() const { return queuedCount.load(); }
+    bool hasOutstandingWork() const { return outstanding.load() > 0; }
+    int outstandingWork() const { return outstanding.load(); }
+    int queueDepth(int coreId) const { return queues[coreId]->size(); }
+    const CoreQueueStats& coreStats(int coreId) const { return *stats[coreId]; }
+};
+
+extern WorkStealingRunQueues runQueues;
+
+#endif // RUN_QUEUE_H
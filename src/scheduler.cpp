@@ -1,164 +1,376 @@
 #include "scheduler.h"
 #include "globals.h"
 #include "config.h"
-#include "instruction.h"
+#include "bytecode.h"
 #include "memory_manager.h"
 #include "utils.h"
+#include "run_queue.h"
+#include "sim_clock.h"
+#include "scheduling_policy.h"
+#include "contiguous_allocator.h"
+#include "reports.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
 #include <fstream>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <limits>
 
-void cpuWorkerWithInstructions(int coreId) {
-    while (!stopScheduler || !coreQueues[coreId].empty()) {
-        int pid = -1;
+static std::string screenLogName(int pid) {
+    return std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid) + ".txt";
+}
+
+static std::atomic<long long> enqueueSequence(0);
+
+// Processes created but not yet admitted to a core's run queue, with the
+// memory each one asks for.
+struct PendingProcess {
+    int pid;
+    int bytes;
+};
+static std::queue<PendingProcess> pendingProcesses;
+static std::mutex pendingMutex;
+
+// Thrashing control, also under pendingMutex. Once a pressure-window
+// takes more than pressure-high-faults faults, admission stops and the
+// process that faulted most is picked for suspension; the core that next
+// dispatches it swaps it out instead of running it. A window with at most
+// pressure-low-faults faults resumes the longest suspended process, and
+// admission reopens once none is left.
+static std::set<int> suspendRequests;
+static std::deque<int> suspendedProcesses;
+static PressureStatistics pressureStats;
+
+// What the scheduler thread saw at the end of the previous window.
+struct PressureWindow {
+    int ticks = 0;
+    long long faults = 0;
+    std::unordered_map<int, long long> faultsByProcess;
+};
+
+int programLength(const Session& session) {
+    return session.program ? static_cast<int>(session.program->code.size()) : config.prints_per_process;
+}
+
+static ReadyKey readyKeyFor(int pid) {
+    std::lock_guard<std::mutex> lock(sessionMutex);
+    return schedulingPolicy->readyKey(sessions[pid], enqueueSequence++);
+}
+
+// Hands a newly created process to the scheduler thread for admission.
+void submitProcess(int pid) {
+    int bytes;
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        sessions[pid].arrivalTick = static_cast<long long>(simClock.now());
+        bytes = sessions[pid].memorySize;
+    }
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pendingProcesses.push({pid, bytes});
+}
+
+enum class Placement { PLACED, WAITING, REJECTED };
+
+// Gives the process its contiguous block, if a memory-allocator is set.
+// WAITING while no free block is large enough; a process too large for
+// memory even when it is empty is finished on the spot.
+static Placement reserveMemory(int pid, int bytes) {
+    if (!contiguousAllocator) return Placement::PLACED;
+    {
+        std::lock_guard<std::mutex> lock(memoryMutex);
+        if (contiguousAllocator->allocate(pid, bytes) != -1) return Placement::PLACED;
+        if (contiguousAllocator->canEverFit(bytes)) return Placement::WAITING;
+    }
+
+    std::cerr << "Error: Process " << pid << " needs " << bytes << " bytes, more than "
+              << config.memory_allocator << " can place in " << config.max_memory_size << " bytes.\n";
+    {
+        std::lock_guard<std::mutex> sessionLock(sessionMutex);
+        sessions[pid].context.state = ProcessState::FINISHED;
+        sessions[pid].completionTick = static_cast<long long>(simClock.now());
+        sessions[pid].finished = true;
+    }
+    demandPagingAllocator.freeProcessPages(pid);
+    return Placement::REJECTED;
+}
+
+static void releaseMemory(int pid) {
+    if (!contiguousAllocator) return;
+    std::lock_guard<std::mutex> lock(memoryMutex);
+    contiguousAllocator->release(pid);
+}
+
+// Puts a process on the ready queue of the core with the shortest backlog.
+static void admitProcess(int pid) {
+    int target = 0;
+    for (int core = 1; core < runQueues.numCores(); ++core) {
+        if (runQueues.queueDepth(core) < runQueues.queueDepth(target)) target = core;
+    }
+    runQueues.submit(target, pid, readyKeyFor(pid));
+}
+
+void resetScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        std::queue<PendingProcess> empty;
+        std::swap(pendingProcesses, empty);
+        suspendRequests.clear();
+        suspendedProcesses.clear();
+        pressureStats = PressureStatistics();
+    }
+    runQueues.clear();
+    enqueueSequence = 0;
+}
+
+PressureStatistics getPressureStatistics() {
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    PressureStatistics snapshot = pressureStats;
+    snapshot.suspended = static_cast<int>(suspendedProcesses.size());
+    return snapshot;
+}
+
+// Compares the faults of the window that just ended with the thresholds
+// and picks a process to suspend or resume. A process is only suspended
+// while another one is left running, and below the high mark a core with
+// nothing to run brings one back, so pressure alone never stalls the
+// system.
+static void balanceMemoryPressure(PressureWindow& window) {
+    MemoryPressure pressure = demandPagingAllocator.getMemoryPressure();
+    long long faults = pressure.faults - window.faults;
+    window.faults = pressure.faults;
+
+    // Candidates by faults in this window, ties to the larger resident set
+    std::vector<std::pair<std::pair<long long, int>, int>> candidates;
+    std::unordered_map<int, long long> previous;
+    previous.swap(window.faultsByProcess);
+    for (const auto& process : pressure.processes) {
+        window.faultsByProcess[process.processId] = process.faults;
+        auto it = previous.find(process.processId);
+        long long recent = process.faults - (it != previous.end() ? it->second : 0);
+        if (recent > 0) candidates.push_back({{recent, process.residentPages}, process.processId});
+    }
+    std::sort(candidates.rbegin(), candidates.rend());
+
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pressureStats.windowFaults = faults;
+    pressureStats.freeFrames = pressure.freeFrames;
+    int running = runQueues.outstandingWork() - static_cast<int>(suspendRequests.size());
+
+    if (faults > config.pressure_high_faults) {
+        pressureStats.admissionHeld = true;
+        if (running <= 1) return;
+        for (const auto& candidate : candidates) {
+            int pid = candidate.second;
+            if (suspendRequests.count(pid)) continue;
+            std::lock_guard<std::mutex> sessionLock(sessionMutex);
+            ProcessState state = sessions[pid].context.state;
+            if (state == ProcessState::SUSPENDED || state == ProcessState::FINISHED) continue;
+            suspendRequests.insert(pid);
+            return;
+        }
+    } else if (faults <= config.pressure_low_faults || running < runQueues.numCores()) {
+        if (suspendedProcesses.empty()) {
+            pressureStats.admissionHeld = false;
+            return;
+        }
+        int pid = suspendedProcesses.front();
+        suspendedProcesses.pop_front();
         {
-            std::unique_lock<std::mutex> lock(coreMutexes[coreId]);
-            coreCVs[coreId].wait(lock, [&] {
-                return !coreQueues[coreId].empty() || stopScheduler;
-            });
-            if (!coreQueues[coreId].empty()) {
-                pid = coreQueues[coreId].front();
-                coreQueues[coreId].pop();
-            } else {
-                // Core is idle for this tick
-                total_cpu_idle_ticks++;
-                continue;
-            }
+            std::lock_guard<std::mutex> sessionLock(sessionMutex);
+            sessions[pid].context.state = ProcessState::READY;
         }
+        pressureStats.resumes++;
+        admitProcess(pid);
+    }
+}
 
-        // Core is active for this tick
-        total_cpu_active_ticks++;
+// Swaps out a process picked for suspension instead of running it. It is
+// listed as suspended before it stops counting as outstanding, so the
+// scheduler cannot finish while it waits to be resumed.
+static bool suspendIfRequested(int pid) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        if (suspendRequests.erase(pid) == 0) return false;
         {
-            std::lock_guard<std::mutex> lock(sessionMutex);
-            sessions[pid].cpu_active_ticks++;
+            std::lock_guard<std::mutex> sessionLock(sessionMutex);
+            sessions[pid].context.state = ProcessState::SUSPENDED;
         }
+        suspendedProcesses.push_back(pid);
+        pressureStats.suspensions++;
+        runQueues.complete();
+    }
+    int freed = demandPagingAllocator.suspendProcess(pid);
+    std::lock_guard<std::mutex> lock(pendingMutex);
+    pressureStats.pagesSwappedOut += freed;
+    return true;
+}
 
-        if (pid == -1) continue;
+// Runs one time slice of a process on this core, one tick per iteration,
+// resuming from the program counter saved in the session's context. Returns
+// true once the process has executed its last instruction. The context is
+// advanced on a local copy and published under sessionMutex every tick, as
+// screen -r and process-smi read it from the main thread.
+static bool runTimeSlice(int coreId, int pid) {
+    Session* found;
+    ExecutionContext ctx;
+    int length;
+    int slice;
+    {
+        std::lock_guard<std::mutex> lock(sessionMutex);
+        found = &sessions[pid];
+        ctx = found->context;
+        length = programLength(*found);
+        slice = schedulingPolicy->timeSlice(*found);
+    }
+    Session& session = *found;
+    // An empty program, or one that already ran its last instruction
+    if (ctx.programCounter >= length) return true;
 
-        if (!sessions[pid].instructions.empty()) {
-            {
-                std::lock_guard<std::mutex> lock(sessionMutex);
-                std::cout << "\nExecuting custom instructions for process " << pid 
-                          << " (" << processNames[pid] << "):\n";
-            }
-            
-            for (size_t i = 0; i < sessions[pid].instructions.size(); ++i) {
-                const auto& instruction = sessions[pid].instructions[i];
-                std::cout << "Instruction " << (i + 1) << "/" << sessions[pid].instructions.size() << ": ";
-                
-                if (!executeInstructionWithPaging(pid, instruction)) {
-                    std::cerr << "Failed to execute instruction " << (i + 1) << " for process " << pid << "\n";
-                    break;
-                }
-                
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            }
-            
-            {
-                std::lock_guard<std::mutex> lock(sessionMutex);
-                std::cout << "Process " << pid << " (" << processNames[pid] << ") completed all instructions.\n\n";
+    std::ofstream log(screenLogName(pid).c_str(),
+                      ctx.programCounter == 0 && ctx.remainingDelay == 0 ? std::ios::trunc : std::ios::app);
+    // A slice spans many ticks, so each line is stamped when it is written
+    auto stamp = [coreId] {
+        return "(" + formatTimestamp(Clock::now()) + ") Core:" + std::to_string(coreId) + " ";
+    };
+
+    for (int used = 0; slice == 0 || used < slice; ++used) {
+        if (ctx.remainingDelay > 0) {
+            // Busy-waiting on the CPU after the previous instruction
+            ctx.remainingDelay--;
+        } else if (session.program) {
+            const BytecodeOp& op = session.program->code[ctx.programCounter];
+            log << stamp();
+            if (!executeBytecodeOp(pid, session, op, log)) {
+                log << "Failed to execute instruction " << (ctx.programCounter + 1) << "\n";
+                ctx.programCounter = length;
+            } else {
+                ctx.programCounter++;
             }
+            ctx.remainingDelay = std::max(0, config.delays_per_exec);
         } else {
-            std::string fname = std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid) + ".txt";
-            std::ofstream ofs(fname.c_str(), std::ios::trunc);
-            for (int i = 0; i < config.prints_per_process; ++i) {
-                auto now = Clock::now();
-                {
-                    std::lock_guard<std::mutex> lock(sessionMutex);
-                    ofs << "(" << formatTimestamp(now) << ") Core:" << coreId
-                        << " \"Hello world from " << (processNames.count(pid) ? processNames[pid] : (std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid))) << "!\"\n";
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(50));
-            }
-            ofs.close();
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            log << stamp() << "\"Hello world from " << processNames[pid] << "!\"\n";
+            ctx.programCounter++;
+            ctx.remainingDelay = std::max(0, config.delays_per_exec);
         }
 
+        simClock.awaitTicks(1);
+        total_cpu_active_ticks++;
         {
             std::lock_guard<std::mutex> lock(sessionMutex);
-            sessions[pid].finished = true;
+            session.cpu_active_ticks++;
+            session.context.programCounter = ctx.programCounter;
+            session.context.remainingDelay = ctx.remainingDelay;
         }
+
+        if (ctx.programCounter >= length) return true;
     }
+    return false;
 }
 
-void schedulerThread() {
-    if (config.scheduler == "rr") {
-        std::queue<int> readyQueue;
+void cpuWorkerWithInstructions(int coreId) {
+    demandPagingAllocator.bindCore(coreId);
+    while (true) {
+        int pid = -1;
+        if (!runQueues.acquire(coreId, pid)) {
+            if (stopScheduler && !admissionOpen && !runQueues.hasOutstandingWork()) break;
 
-        for (int pid = 1; pid <= config.num_processes; ++pid) {
-            readyQueue.push(pid);
-            {
-                std::lock_guard<std::mutex> lock(sessionMutex);
-                Session s;
-                s.start = Clock::now();
-                s.finished = false;
-                s.memorySize = config.mem_per_proc;
-                sessions[pid] = std::move(s);
-                processNames[pid] = std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid);
-
-                createProcessMemoryLayout(pid, config.mem_per_proc);
-            }
+            // Nothing to run or steal: core is idle for this tick
+            total_cpu_idle_ticks++;
+            runQueues.recordIdle(coreId);
+            simClock.awaitTicks(1);
+            continue;
         }
+        if (suspendIfRequested(pid)) continue;
 
-        int currentCore = 0;
-
-        while (!readyQueue.empty()) {
-
-            int pid = readyQueue.front();
-            readyQueue.pop();
-
-            // Memory allocation logic needs to be here
+        {
+            std::lock_guard<std::mutex> lock(sessionMutex);
+            Session& session = sessions[pid];
+            session.lastCore = coreId;
+            session.context.state = ProcessState::RUNNING;
+            if (session.firstRunTick < 0) {
+                session.firstRunTick = static_cast<long long>(simClock.now());
+            }
+        }
 
+        demandPagingAllocator.switchContext(pid);
+        if (runTimeSlice(coreId, pid)) {
             {
-                std::lock_guard<std::mutex> lock(coreMutexes[currentCore]);
-                coreQueues[currentCore].push(pid);
+                std::lock_guard<std::mutex> lock(sessionMutex);
+                sessions[pid].context.state = ProcessState::FINISHED;
+                sessions[pid].completionTick = static_cast<long long>(simClock.now());
+                sessions[pid].finished = true;
             }
-
-            coreCVs[currentCore].notify_one();
-            std::this_thread::sleep_for(std::chrono::milliseconds(config.quantum_cycles));
-            // snapshotMemory(); // This function needs to be available
-
+            {
+                // Picked for suspension while running its last slice
+                std::lock_guard<std::mutex> lock(pendingMutex);
+                suspendRequests.erase(pid);
+            }
+            releaseMemory(pid);
+            demandPagingAllocator.freeProcessPages(pid);
+            runQueues.complete();
+        } else {
+            // Quantum expired: save the context and let the policy re-rank it
             {
                 std::lock_guard<std::mutex> lock(sessionMutex);
-                if (!sessions[pid].finished) {
-                    readyQueue.push(pid);
-                } else {
-                    // freeMemory(pid); // This function needs to be available
-                    demandPagingAllocator.freeProcessPages(pid);
-                }
+                sessions[pid].context.state = ProcessState::READY;
+                schedulingPolicy->onQuantumExpired(sessions[pid]);
             }
-        currentCore = (currentCore + 1) % config.num_cpu;
+            runQueues.requeue(coreId, pid, readyKeyFor(pid));
         }
+    }
+    simClock.detach();
+}
 
-        stopScheduler = true;
-        for (int i = 0; i < config.num_cpu; ++i)
-            coreCVs[i].notify_all();
+// Long-term scheduler: admits submitted processes into the run queues each
+// tick and keeps going after scheduler-stop until nothing is left pending
+// or suspended. Admission waits while memory pressure is high.
+void schedulerThread() {
+    PressureWindow window;
+    while (true) {
+        if (config.pressure_high_faults > 0 && ++window.ticks >= std::max(1, config.pressure_window)) {
+            window.ticks = 0;
+            balanceMemoryPressure(window);
+        }
 
-    } else {
-        for (int pid = 1; pid <= config.num_processes; ++pid) {
-            int assignedCore = (pid - 1) % config.num_cpu;
-            {
-                std::lock_guard<std::mutex> lock(coreMutexes[assignedCore]);
-                coreQueues[assignedCore].push(pid);
-
-                {
-                    std::lock_guard<std::mutex> lock(sessionMutex);
-                    Session s;
-                    s.start = Clock::now();
-                    s.finished = false;
-                    s.memorySize = config.mem_per_proc;
-                    sessions[pid] = std::move(s);
-                    processNames[pid] = std::string("screen_") + (pid < 10 ? "0" : "") + std::to_string(pid);
-                    
-                    createProcessMemoryLayout(pid, config.mem_per_proc);
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex);
+            if (pressureStats.admissionHeld) {
+                // New processes would only add to the thrashing
+                if (!pendingProcesses.empty()) pressureStats.heldTicks++;
+            } else {
+                // Processes that do not fit yet wait, in order, for a later tick.
+                // Once a request fails, no larger one is tried this tick.
+                std::queue<PendingProcess> waiting;
+                int smallestWaiting = std::numeric_limits<int>::max();
+                while (!pendingProcesses.empty()) {
+                    PendingProcess next = pendingProcesses.front();
+                    pendingProcesses.pop();
+                    Placement placement = next.bytes < smallestWaiting ? reserveMemory(next.pid, next.bytes)
+                                                                       : Placement::WAITING;
+                    if (placement == Placement::PLACED) {
+                        admitProcess(next.pid);
+                    } else if (placement == Placement::WAITING) {
+                        smallestWaiting = std::min(smallestWaiting, next.bytes);
+                        waiting.push(next);
+                    }
                 }
+                std::swap(pendingProcesses, waiting);
             }
-            coreCVs[assignedCore].notify_one();
-            std::this_thread::sleep_for(std::chrono::milliseconds(500));
+            drained = stopScheduler && !generatorRunning && pendingProcesses.empty() &&
+                      suspendRequests.empty() && suspendedProcesses.empty();
         }
+        if (drained) break;
 
-        stopScheduler = true;
-        for (int i = 0; i < config.num_cpu; ++i)
-            coreCVs[i].notify_all();
+        simClock.awaitTicks(1);
+        if (enableSnapshots) snapshotMemory();
     }
+
+    admissionOpen = false;
+    simClock.detach();
 }
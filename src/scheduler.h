@@ -1,7 +1,25 @@
 #ifndef SCHEDULER_H
 #define SCHEDULER_H
 
+#include "structures.h"
+
+// Thrashing control over the last complete pressure-window.
+struct PressureStatistics {
+    long long windowFaults = 0;      // faults that took a frame in the last window
+    int freeFrames = 0;              // at the end of that window
+    bool admissionHeld = false;
+    long long heldTicks = 0;         // ticks new processes waited on memory pressure
+    int suspended = 0;               // processes swapped out right now
+    long long suspensions = 0;
+    long long resumes = 0;
+    long long pagesSwappedOut = 0;   // frames freed by suspending processes
+};
+
 void schedulerThread();
 void cpuWorkerWithInstructions(int coreId);
+void submitProcess(int pid);
+void resetScheduler();
+int programLength(const Session& session);
+PressureStatistics getPressureStatistics();
 
 #endif // SCHEDULER_H
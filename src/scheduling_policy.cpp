@@ -0,0 +1,70 @@
+#include "scheduling_policy.h"
+#include "scheduler.h"
+#include "sim_clock.h"
+#include "config.h"
+#include <iostream>
+#include <algorithm>
+
+std::unique_ptr<SchedulingPolicy> schedulingPolicy(new FcfsPolicy());
+
+static ReadyKey rankedKey(long long rank, long long sequence) {
+    return ReadyKey(rank, sequence);
+}
+
+int FcfsPolicy::timeSlice(const Session& session) const {
+    return 0;
+}
+
+ReadyKey FcfsPolicy::readyKey(const Session& session, long long sequence) const {
+    return rankedKey(0, sequence);
+}
+
+int RoundRobinPolicy::timeSlice(const Session& session) const {
+    return std::max(1, config.quantum_cycles);
+}
+
+ReadyKey RoundRobinPolicy::readyKey(const Session& session, long long sequence) const {
+    return rankedKey(0, sequence);
+}
+
+int ShortestJobFirstPolicy::timeSlice(const Session& session) const {
+    return 0;
+}
+
+ReadyKey ShortestJobFirstPolicy::readyKey(const Session& session, long long sequence) const {
+    long long remaining = programLength(session) - session.context.programCounter;
+    return rankedKey(std::max(0LL, remaining), sequence);
+}
+
+int PriorityPolicy::timeSlice(const Session& session) const {
+    return std::max(1, config.quantum_cycles);
+}
+
+ReadyKey PriorityPolicy::readyKey(const Session& session, long long sequence) const {
+    return rankedKey(std::max(0, session.priority), sequence);
+}
+
+int MlfqPolicy::timeSlice(const Session& session) const {
+    return std::max(1, config.quantum_cycles) << session.queueLevel;
+}
+
+ReadyKey MlfqPolicy::readyKey(const Session& session, long long sequence) const {
+    long long eligibleTick = static_cast<long long>(simClock.now()) +
+                             static_cast<long long>(session.queueLevel) * config.mlfq_aging_ticks;
+    return rankedKey(eligibleTick, sequence);
+}
+
+void MlfqPolicy::onQuantumExpired(Session& session) {
+    session.queueLevel = std::min(session.queueLevel + 1, std::max(1, config.mlfq_levels) - 1);
+}
+
+std::unique_ptr<SchedulingPolicy> createSchedulingPolicy(const std::string& name) {
+    if (name == "fcfs") return std::unique_ptr<SchedulingPolicy>(new FcfsPolicy());
+    if (name == "rr") return std::unique_ptr<SchedulingPolicy>(new RoundRobinPolicy());
+    if (name == "sjf") return std::unique_ptr<SchedulingPolicy>(new ShortestJobFirstPolicy());
+    if (name == "priority") return std::unique_ptr<SchedulingPolicy>(new PriorityPolicy());
+    if (name == "mlfq") return std::unique_ptr<SchedulingPolicy>(new MlfqPolicy());
+
+    std::cerr << "Warning: Unknown scheduler '" << name << "'. Using fcfs.\n";
+    return std::unique_ptr<SchedulingPolicy>(new FcfsPolicy());
+}
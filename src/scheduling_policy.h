@@ -0,0 +1,71 @@
+#ifndef SCHEDULING_POLICY_H
+#define SCHEDULING_POLICY_H
+
+#include "structures.h"
+#include "run_queue.h"
+#include <string>
+#include <memory>
+
+// Decides how long a process may hold a core and in what order ready
+// processes are dispatched. Run queues are ordered by readyKey(), lowest
+// first; sequence is a global enqueue counter that breaks ties in FIFO order.
+class SchedulingPolicy {
+public:
+    virtual ~SchedulingPolicy() = default;
+    virtual std::string name() const = 0;
+
+    // Ticks a process may run before preemption; 0 runs it to completion.
+    virtual int timeSlice(const Session& session) const = 0;
+    virtual ReadyKey readyKey(const Session& session, long long sequence) const = 0;
+
+    // Called when a process used up its whole time slice.
+    virtual void onQuantumExpired(Session& session) {}
+};
+
+class FcfsPolicy : public SchedulingPolicy {
+public:
+    std::string name() const override { return "fcfs"; }
+    int timeSlice(const Session& session) const override;
+    ReadyKey readyKey(const Session& session, long long sequence) const override;
+};
+
+class RoundRobinPolicy : public SchedulingPolicy {
+public:
+    std::string name() const override { return "rr"; }
+    int timeSlice(const Session& session) const override;
+    ReadyKey readyKey(const Session& session, long long sequence) const override;
+};
+
+// Non-preemptive shortest job first on remaining instruction count.
+class ShortestJobFirstPolicy : public SchedulingPolicy {
+public:
+    std::string name() const override { return "sjf"; }
+    int timeSlice(const Session& session) const override;
+    ReadyKey readyKey(const Session& session, long long sequence) const override;
+};
+
+// Static priority (0 is highest), round robin among equal priorities.
+class PriorityPolicy : public SchedulingPolicy {
+public:
+    std::string name() const override { return "priority"; }
+    int timeSlice(const Session& session) const override;
+    ReadyKey readyKey(const Session& session, long long sequence) const override;
+};
+
+// Multi-level feedback queue. A process drops one level each time it uses a
+// full slice and the slice doubles per level. Instead of periodic boosts a
+// level only delays a process by mlfq-aging-ticks per level, so long waiters
+// eventually outrank fresh arrivals and cannot starve.
+class MlfqPolicy : public SchedulingPolicy {
+public:
+    std::string name() const override { return "mlfq"; }
+    int timeSlice(const Session& session) const override;
+    ReadyKey readyKey(const Session& session, long long sequence) const override;
+    void onQuantumExpired(Session& session) override;
+};
+
+std::unique_ptr<SchedulingPolicy> createSchedulingPolicy(const std::string& name);
+
+extern std::unique_ptr<SchedulingPolicy> schedulingPolicy;
+
+#endif // SCHEDULING_POLICY_H
@@ -0,0 +1,57 @@
+#include "sim_clock.h"
+#include <thread>
+
+SimClock simClock;
+
+SimClock::SimClock()
+    : currentTick(0), participants(0), arrived(0), advancing(false),
+      virtualMode(false), tickDuration(100), tickStarted(std::chrono::steady_clock::now()) {}
+
+void SimClock::configure(bool virtualClock, int tickMs) {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    virtualMode = virtualClock;
+    tickDuration = std::chrono::milliseconds(tickMs > 0 ? tickMs : 1);
+    tickStarted = std::chrono::steady_clock::now();
+}
+
+void SimClock::advanceLocked(std::unique_lock<std::mutex>& lock) {
+    advancing = true;
+    if (!virtualMode) {
+        auto deadline = tickStarted + tickDuration;
+        lock.unlock();
+        std::this_thread::sleep_until(deadline);
+        lock.lock();
+    }
+    currentTick++;
+    arrived = 0;
+    advancing = false;
+    tickStarted = std::chrono::steady_clock::now();
+    tickCV.notify_all();
+}
+
+void SimClock::attach(int threads) {
+    std::lock_guard<std::mutex> lock(clockMutex);
+    participants += threads;
+}
+
+void SimClock::detach() {
+    std::unique_lock<std::mutex> lock(clockMutex);
+    participants--;
+    // The leaving thread may have been the last one the tick was waiting on
+    if (participants > 0 && arrived >= participants && !advancing) {
+        advanceLocked(lock);
+    }
+}
+
+void SimClock::awaitTicks(unsigned long long ticks) {
+    std::unique_lock<std::mutex> lock(clockMutex);
+    for (unsigned long long i = 0; i < ticks; ++i) {
+        unsigned long long tickAtArrival = currentTick.load();
+        arrived++;
+        if (arrived >= participants && !advancing) {
+            advanceLocked(lock);
+        } else {
+            tickCV.wait(lock, [&] { return currentTick.load() != tickAtArrival; });
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+// Global CPU-cycle counter shared by the scheduler and every core worker.
+// Each attached thread calls awaitTicks() to consume ticks; the clock only
+// advances once every attached thread has arrived at the current tick.
+// Threads are attached by whoever spawns them, before they start, so an
+// early starter cannot run the clock ahead on its own.
+// In virtual mode the last arrival advances the clock immediately, so the
+// simulation runs as fast as the host allows. In realtime mode each tick
+// lasts at least tick-ms of wall-clock time for demos.
+class SimClock {
+private:
+    std::atomic<unsigned long long> currentTick;
+    std::mutex clockMutex;
+    std::condition_variable tickCV;
+    int participants;
+    int arrived;
+    bool advancing;
+    bool virtualMode;
+    std::chrono::milliseconds tickDuration;
+    std::chrono::steady_clock::time_point tickStarted;
+
+    void advanceLocked(std::unique_lock<std::mutex>& lock);
+
+public:
+    SimClock();
+    void configure(bool virtualClock, int tickMs);
+    void attach(int threads = 1);
+    void detach();
+    void awaitTicks(unsigned long long ticks);
+
+    unsigned long long now() const { return currentTick.load(); }
+    bool isVirtual() const { return virtualMode; }
+};
+
+extern SimClock simClock;
+
+#endif // SIM_CLOCK_H
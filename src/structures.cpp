@@ -1,49 +1,80 @@
 #include "structures.h"
 #include "config.h"
 
-PageTable::PageTable(int pages_needed) : numPages(pages_needed) {
-    pages.resize(pages_needed);
+PageTable::PageTable(int pages_needed)
+    : numPages(pages_needed), directorySize((pages_needed + LEAF_SIZE - 1) / LEAF_SIZE), leafCount(0) {
+    directory.reset(new std::atomic<Leaf*>[directorySize]);
+    for (int i = 0; i < directorySize; ++i) directory[i].store(nullptr);
 }
 
-ProcessMemoryLayout::ProcessMemoryLayout(int memSize) : pageTable(0), totalMemorySize(memSize) {
-    int pagesNeeded = (memSize + config.mem_per_frame - 1) / config.mem_per_frame;
-    pageTable = PageTable(pagesNeeded);
+PageTable::~PageTable() {
+    for (int i = 0; i < directorySize; ++i) delete[] directory[i].load();
+}
+
+PageEntry PageTable::entry(int pageNumber) const {
+    PageEntry value;
+    const Leaf* leaf = directory[pageNumber >> LEAF_BITS].load(std::memory_order_acquire);
+    if (leaf) value.bits = leaf[pageNumber & (LEAF_SIZE - 1)].load(std::memory_order_acquire);
+    return value;
+}
+
+// Leaves are published with a compare-and-swap, so a lookup never sees a
+// half-built one and two first touches cannot both install theirs.
+PageTable::Leaf& PageTable::slot(int pageNumber) {
+    std::atomic<Leaf*>& dir = directory[pageNumber >> LEAF_BITS];
+    Leaf* leaf = dir.load(std::memory_order_acquire);
+    if (!leaf) {
+        Leaf* fresh = new Leaf[LEAF_SIZE];
+        for (int i = 0; i < LEAF_SIZE; ++i) fresh[i].store(PageEntry().bits, std::memory_order_relaxed);
+        if (dir.compare_exchange_strong(leaf, fresh, std::memory_order_acq_rel)) {
+            leaf = fresh;
+            leafCount++;
+        } else {
+            delete[] fresh;
+        }
+    }
+    return leaf[pageNumber & (LEAF_SIZE - 1)];
+}
+
+void PageTable::store(int pageNumber, PageEntry value) {
+    slot(pageNumber).store(value.bits, std::memory_order_release);
+}
+
+void PageTable::setFlags(int pageNumber, uint32_t flags) {
+    slot(pageNumber).fetch_or(flags, std::memory_order_acq_rel);
+}
+
+void PageTable::clearFlags(int pageNumber, uint32_t flags) {
+    slot(pageNumber).fetch_and(~flags, std::memory_order_acq_rel);
+}
+
+size_t PageTable::overheadBytes() const {
+    return static_cast<size_t>(directorySize) * sizeof(Leaf*) +
+           static_cast<size_t>(leafCount.load()) * LEAF_SIZE * sizeof(Leaf);
+}
+
+ProcessMemoryLayout::ProcessMemoryLayout(int memSize)
+    : pageTable((memSize + config.mem_per_frame - 1) / config.mem_per_frame), totalMemorySize(memSize) {
     initializeSegments();
 }
 
 void ProcessMemoryLayout::initializeSegments() {
-    segments.emplace_back(0, 64, "symbol_table");
-    int remainingMemory = totalMemorySize - 64;
+    segments.emplace_back(0, SYMBOL_TABLE_SIZE, "symbol_table");
+    int remainingMemory = totalMemorySize - SYMBOL_TABLE_SIZE;
     if (remainingMemory > 0) {
         int codeSize = (remainingMemory * 40) / 100;
         int stackSize = (remainingMemory * 30) / 100;
         int heapSize = remainingMemory - codeSize - stackSize;
-        segments.emplace_back(64, codeSize, "code");
-        segments.emplace_back(64 + codeSize, stackSize, "stack");
-        segments.emplace_back(64 + codeSize + stackSize, heapSize, "heap");
+        segments.emplace_back(SYMBOL_TABLE_SIZE, codeSize, "code");
+        segments.emplace_back(SYMBOL_TABLE_SIZE + codeSize, stackSize, "stack");
+        segments.emplace_back(SYMBOL_TABLE_SIZE + codeSize + stackSize, heapSize, "heap");
     }
 }
 
 PhysicalFrame::PhysicalFrame() : frameNumber(-1), processId(-1), pageNumber(-1),
-                                 isOccupied(false), isDirty(false), lastAccessed(Clock::now()) {}
+                                 isOccupied(false), refCount(0), isDirty(false), isPrefetched(false),
+                                 isReferenced(false), lastAccessTick(0) {}
 
 PhysicalFrame::PhysicalFrame(int frameNum) : frameNumber(frameNum), processId(-1), pageNumber(-1),
-                                             isOccupied(false), isDirty(false), lastAccessed(Clock::now()) {}
-
-BackingStore::BackingStore() {
-    processPages.resize(1000);  // Support up to 1000 processes
-    for (auto& pages : processPages) {
-        pages.resize(1000, 0);  // Each process can have up to 1000 pages
-    }
-}
-
-void BackingStore::storePage(int processId, int pageNumber, const std::vector<int>& pageData) {
-    std::lock_guard<std::mutex> lock(backingStoreMutex);
-    // Implementation of writePageToBackingStore is needed here
-}
-
-std::vector<int> BackingStore::loadPage(int processId, int pageNumber) {
-    std::lock_guard<std::mutex> lock(backingStoreMutex);
-    // Implementation of readPageFromBackingStore is needed here
-    return {};
-}
+                                             isOccupied(false), refCount(0), isDirty(false), isPrefetched(false),
+                                             isReferenced(false), lastAccessTick(0) {}
@@ -9,17 +9,51 @@
 #include <chrono>
 #include <memory>
 #include <atomic>
+#include <cstdint>
 #include <mutex>
 
 using Clock = std::chrono::system_clock;
 
+// Variables live in fixed-width slots at the start of every process's
+// address space.
+const int SYMBOL_TABLE_SIZE = 64;
+const int SYMBOL_SLOT_SIZE = static_cast<int>(sizeof(int));
+const int MAX_SYMBOLS = SYMBOL_TABLE_SIZE / SYMBOL_SLOT_SIZE;
+
+// One page-table entry packed into a word: the frame number in the low
+// bits plus loaded, dirty, accessed and copy-on-write flags. An all-ones
+// frame field means the page has no frame. A copy-on-write page may be
+// read in place but must get a frame of its own before it is written.
 struct PageEntry {
-    int physicalFrame;
-    bool isLoaded;
-    bool isDirty;
-    bool isAccessed;
+    static const uint32_t LOADED = 1u << 31;
+    static const uint32_t DIRTY = 1u << 30;
+    static const uint32_t ACCESSED = 1u << 29;
+    static const uint32_t COPY_ON_WRITE = 1u << 28;
+    static const uint32_t FRAME_MASK = COPY_ON_WRITE - 1;
+
+    uint32_t bits;
+
+    PageEntry() : bits(FRAME_MASK) {}
 
-    PageEntry() : physicalFrame(-1), isLoaded(false), isDirty(false), isAccessed(false) {}
+    int physicalFrame() const {
+        uint32_t frame = bits & FRAME_MASK;
+        return frame == FRAME_MASK ? -1 : static_cast<int>(frame);
+    }
+    bool isLoaded() const { return (bits & LOADED) != 0; }
+    bool isDirty() const { return (bits & DIRTY) != 0; }
+    bool isAccessed() const { return (bits & ACCESSED) != 0; }
+    bool isCopyOnWrite() const { return (bits & COPY_ON_WRITE) != 0; }
+
+    void setPhysicalFrame(int frame) {
+        bits = (bits & ~FRAME_MASK) | (frame < 0 ? FRAME_MASK : static_cast<uint32_t>(frame));
+    }
+    void setLoaded(bool on) { setFlag(LOADED, on); }
+    void setDirty(bool on) { setFlag(DIRTY, on); }
+    void setAccessed(bool on) { setFlag(ACCESSED, on); }
+    void setCopyOnWrite(bool on) { setFlag(COPY_ON_WRITE, on); }
+
+private:
+    void setFlag(uint32_t flag, bool on) { bits = on ? (bits | flag) : (bits & ~flag); }
 };
 
 struct Config {
@@ -35,19 +69,83 @@ struct Config {
     int max_overall_mem;
     int mem_per_frame;
     int mem_per_proc = 4096;
+    int min_mem_per_proc = 4096;
+    int max_mem_per_proc = 4096;
     int min_memory_size = 64;
     int max_memory_size = 65536;
     int num_frames = 1024;
     int backing_store_size = 65536;
+    int compressed_swap_size = 0;
+    std::string clock_mode = "realtime";
+    int tick_ms = 100;
+    int mlfq_levels = 3;
+    int mlfq_aging_ticks = 1000;
+    bool verbose_paging = true;
+    std::string page_replacement = "clock";
+    bool page_replacement_compare = false;
+    int tlb_entries = 16;
+    int writeback_watermark = 4;
+    int writeback_batch = 8;
+    int readahead_max = 8;
+    int dedup_scan_pages = 0;
+    int dedup_sleep_ms = 50;
+    int pressure_window = 20;
+    int pressure_high_faults = 0;
+    int pressure_low_faults = 0;
+    std::string memory_allocator = "none";
 };
 
-struct PageTable {
-    std::vector<PageEntry> pages;
-    int numPages;
+// Two-level sparse page table. The directory holds one pointer per
+// LEAF_SIZE pages; a leaf of entries is only allocated the first time one
+// of its pages is touched, so untouched parts of the address space cost a
+// null pointer each. Entries are atomic words, so cores can read a
+// translation and set accessed/dirty bits without the pager's lock.
+class PageTable {
+public:
+    static const int LEAF_BITS = 6;
+    static const int LEAF_SIZE = 1 << LEAF_BITS;
 
-    PageTable(int pages_needed = 0);
-};
+    const int numPages;
+
+    explicit PageTable(int pages_needed = 0);
+    ~PageTable();
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
+
+    // Entry for a page without allocating; untouched pages read as empty.
+    PageEntry entry(int pageNumber) const;
+    // The setters allocate the page's leaf on first touch.
+    void store(int pageNumber, PageEntry value);
+    void setFlags(int pageNumber, uint32_t flags);
+    void clearFlags(int pageNumber, uint32_t flags);
+
+    // Calls fn(page, entry) for each loaded page, skipping leaves never allocated.
+    template <typename Fn>
+    void forEachLoaded(Fn fn) const {
+        for (int d = 0; d < directorySize; ++d) {
+            const Leaf* leaf = directory[d].load(std::memory_order_acquire);
+            if (!leaf) continue;
+            for (int i = 0; i < LEAF_SIZE && (d << LEAF_BITS) + i < numPages; ++i) {
+                PageEntry value;
+                value.bits = leaf[i].load(std::memory_order_acquire);
+                if (value.isLoaded()) fn((d << LEAF_BITS) + i, value);
+            }
+        }
+    }
+
+    int leavesAllocated() const { return leafCount.load(); }
+    int leafSlots() const { return directorySize; }
+    size_t overheadBytes() const;
+
+private:
+    using Leaf = std::atomic<uint32_t>;
+
+    std::unique_ptr<std::atomic<Leaf*>[]> directory;
+    int directorySize;
+    std::atomic<int> leafCount;
 
+    Leaf& slot(int pageNumber);
+};
 struct MemorySegment {
     int startAddress;
     int size;
@@ -83,9 +181,30 @@ struct Instruction {
         : type(t), operands(ops) {}
 };
 
+// Which symbol-table slots hold a declared variable. The values themselves
+// live in the symbol_table segment, slot i at virtual address
+// i * SYMBOL_SLOT_SIZE.
 struct ProcessVariables {
-    std::map<std::string, int> variables;
-    std::map<int, int> memory;
+    unsigned int declaredMask = 0;
+
+    bool isDeclared(int slot) const { return (declaredMask >> slot) & 1u; }
+    void markDeclared(int slot) { declaredMask |= 1u << slot; }
+};
+
+struct Program;
+
+enum class ProcessState {
+    READY,
+    RUNNING,
+    SUSPENDED,      // swapped out by the scheduler while memory is overcommitted
+    FINISHED
+};
+
+// Saved CPU state of a process between time slices.
+struct ExecutionContext {
+    int programCounter = 0;
+    int remainingDelay = 0;
+    ProcessState state = ProcessState::READY;
 };
 
 struct Session {
@@ -94,9 +213,17 @@ struct Session {
     int memorySize = 4096;
     std::unique_ptr<ProcessMemoryLayout> memoryLayout;
     std::vector<Instruction> instructions;
+    std::shared_ptr<const Program> program;
     ProcessVariables variables;
+    ExecutionContext context;
     int cpu_active_ticks = 0;
     int cpu_idle_ticks = 0;
+    int lastCore = -1;
+    int priority = 0;
+    int queueLevel = 0;
+    long long arrivalTick = 0;
+    long long firstRunTick = -1;
+    long long completionTick = -1;
 
     Session() = default;
     Session(const Session&) = delete;
@@ -116,20 +243,18 @@ struct PhysicalFrame {
     int processId;
     int pageNumber;
     bool isOccupied;
-    bool isDirty;
-    Clock::time_point lastAccessed;
+    // Mappings of the frame: the owner above plus sharers, (pid, page)
+    // pairs of clones or merged duplicate pages that map it copy-on-write
+    int refCount;
+    std::vector<std::pair<int, int>> sharers;
+    // Set by cores outside the pager's lock, under the frame's stripe lock
+    std::atomic<bool> isDirty;
+    std::atomic<bool> isPrefetched;   // brought in by readahead and not yet accessed
+    std::atomic<bool> isReferenced;   // accessed since the policy last heard about it
+    std::atomic<unsigned long long> lastAccessTick;
 
     PhysicalFrame();
     PhysicalFrame(int frameNum);
 };
 
-struct BackingStore {
-    std::vector<std::vector<int>> processPages;
-    std::mutex backingStoreMutex;
-
-    BackingStore();
-    void storePage(int processId, int pageNumber, const std::vector<int>& pageData);
-    std::vector<int> loadPage(int processId, int pageNumber);
-};
-
 #endif // STRUCTURES_H